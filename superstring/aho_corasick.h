@@ -0,0 +1,167 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+
+// Trie of all strings with failure links: the Aho-Corasick automaton without the full transition table.
+// Children of a node are kept as a sibling list, the alphabet is small
+class AhoCorasick {
+public:
+    AhoCorasick(const std::vector<std::string>& strings)
+        : Terminal_(strings.size())
+    {
+        AddNode(-1, 0);
+        for (int i = 0; i < (int)strings.size(); i++) {
+            int node = 0;
+            for (char c : strings[i]) {
+                int child = FindChild(node, c);
+                if (child == -1) {
+                    child = AddNode(node, c);
+                }
+                node = child;
+            }
+            Terminal_[i] = node;
+        }
+
+        BuildFailLinks();
+    }
+
+    int GetNodeCount() const {
+        return Nodes_.size();
+    }
+
+    int GetDepth(int node) const {
+        return Nodes_[node].depth;
+    }
+
+    int GetFail(int node) const {
+        return Nodes_[node].fail;
+    }
+
+    int GetFirstChild(int node) const {
+        return Nodes_[node].firstChild;
+    }
+
+    int GetNextSibling(int node) const {
+        return Nodes_[node].nextSibling;
+    }
+
+    // Node spelling strings[i]
+    int GetTerminal(int i) const {
+        return Terminal_[i];
+    }
+
+    // State after reading symbol in state node: the longest suffix of (node + symbol) spelled by a trie node
+    int Next(int node, char symbol) const {
+        while (true) {
+            int child = FindChild(node, symbol);
+            if (child != -1) {
+                return child;
+            }
+            if (node == 0) {
+                return 0;
+            }
+            node = Nodes_[node].fail;
+        }
+    }
+
+    // Adds the state reached after every symbol of text to visits, indexed by node
+    void CountVisits(std::string_view text, std::vector<long long>& visits) const {
+        int node = 0;
+        for (char c : text) {
+            node = Next(node, c);
+            visits[node]++;
+        }
+    }
+
+    // Turns node visits into occurrence counts: a string spelled by a node occurs wherever a visited state has it
+    // on its fail chain, so counts are pushed to fail links from the deepest nodes up
+    void AccumulateOverFailLinks(std::vector<long long>& visits) const {
+        for (int i = (int)Order_.size() - 1; i > 0; i--) {
+            int node = Order_[i];
+            visits[Nodes_[node].fail] += visits[node];
+        }
+    }
+
+    // For every node, the position in text where its string first ends, -1 if it does not occur: the earliest
+    // visit of a state having the node on its fail chain
+    std::vector<long long> FindFirstOccurrences(std::string_view text) const {
+        std::vector<long long> first(Nodes_.size(), -1);
+        int node = 0;
+        for (long long i = 0; i < (long long)text.size(); i++) {
+            node = Next(node, text[i]);
+            if (first[node] == -1) {
+                first[node] = i;
+            }
+        }
+
+        for (int i = (int)Order_.size() - 1; i > 0; i--) {
+            int v = Order_[i];
+            long long& target = first[Nodes_[v].fail];
+            if (first[v] != -1 && (target == -1 || first[v] < target)) {
+                target = first[v];
+            }
+        }
+
+        return first;
+    }
+
+private:
+    struct Node {
+        int parent;
+        int depth;
+        int fail = 0;
+        int firstChild = -1;
+        int nextSibling = -1;
+        char symbol;
+    };
+
+    int AddNode(int parent, char symbol) {
+        Nodes_.push_back({parent, parent == -1 ? 0 : Nodes_[parent].depth + 1, 0, -1, -1, symbol});
+
+        int node = Nodes_.size() - 1;
+        if (parent != -1) {
+            Nodes_[node].nextSibling = Nodes_[parent].firstChild;
+            Nodes_[parent].firstChild = node;
+        }
+
+        return node;
+    }
+
+    int FindChild(int node, char symbol) const {
+        for (int child = Nodes_[node].firstChild; child != -1; child = Nodes_[child].nextSibling) {
+            if (Nodes_[child].symbol == symbol) {
+                return child;
+            }
+        }
+
+        return -1;
+    }
+
+    // Breadth-first, so the fail links of shallower nodes are ready
+    void BuildFailLinks() {
+        Order_ = {0};
+        for (int head = 0; head < (int)Order_.size(); head++) {
+            int node = Order_[head];
+            for (int child = Nodes_[node].firstChild; child != -1; child = Nodes_[child].nextSibling) {
+                Order_.push_back(child);
+                if (node == 0) {
+                    continue;
+                }
+
+                int fail = Nodes_[node].fail;
+                while (fail != 0 && FindChild(fail, Nodes_[child].symbol) == -1) {
+                    fail = Nodes_[fail].fail;
+                }
+
+                int next = FindChild(fail, Nodes_[child].symbol);
+                Nodes_[child].fail = next == -1 ? 0 : next;
+            }
+        }
+    }
+
+    std::vector<Node> Nodes_;
+    std::vector<int> Terminal_;
+    std::vector<int> Order_;
+};
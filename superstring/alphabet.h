@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+// Maps the UTF-8 symbols occurring in the strings to dense one-byte codes, so every symbol takes one char
+// instead of up to four and the trie gets one level per symbol. A symbol is the byte sequence of one codepoint,
+// a byte that cannot start a sequence is a symbol on its own. With more than 256 symbols the codes would not fit,
+// then strings are kept as they are
+class Alphabet {
+public:
+    Alphabet(const std::vector<std::string>& strings) {
+        for (const auto& string : strings) {
+            for (size_t i = 0; i < string.size();) {
+                size_t length = SymbolLength(string, i);
+                uint32_t key = Key(string, i, length);
+                if (Codes_.find(key) == Codes_.end()) {
+                    Codes_[key] = Symbols_.size();
+                    Symbols_.push_back(string.substr(i, length));
+                }
+                i += length;
+            }
+        }
+
+        if (Symbols_.size() > 256) {
+            Codes_.clear();
+            Symbols_.clear();
+            Compact_ = false;
+        }
+    }
+
+    bool IsCompact() const {
+        return Compact_;
+    }
+
+    int GetSize() const {
+        return Symbols_.size();
+    }
+
+    std::string Encode(const std::string& string) const {
+        if (!Compact_) {
+            return string;
+        }
+
+        std::string codes;
+        codes.reserve(string.size());
+        for (size_t i = 0; i < string.size();) {
+            size_t length = SymbolLength(string, i);
+            codes.push_back((char)Codes_.at(Key(string, i, length)));
+            i += length;
+        }
+
+        return codes;
+    }
+
+    std::string Decode(const std::string& codes) const {
+        if (!Compact_) {
+            return codes;
+        }
+
+        std::string string;
+        string.reserve(codes.size() * 2);
+        for (char code : codes) {
+            string += Symbols_[(unsigned char)code];
+        }
+
+        return string;
+    }
+
+private:
+    // Bytes in the UTF-8 sequence starting at string[i], 1 for stray continuation bytes and truncated sequences
+    static size_t SymbolLength(const std::string& string, size_t i) {
+        unsigned char lead = string[i];
+        size_t length = 1;
+        if ((lead & 0xE0) == 0xC0) {
+            length = 2;
+        } else if ((lead & 0xF0) == 0xE0) {
+            length = 3;
+        } else if ((lead & 0xF8) == 0xF0) {
+            length = 4;
+        }
+
+        return i + length <= string.size() ? length : 1;
+    }
+
+    static uint32_t Key(const std::string& string, size_t i, size_t length) {
+        uint32_t key = 0;
+        for (size_t j = 0; j < length; j++) {
+            key = key << 8 | (unsigned char)string[i + j];
+        }
+
+        return key;
+    }
+
+    std::unordered_map<uint32_t, int> Codes_;
+    std::vector<std::string> Symbols_;
+    bool Compact_ = true;
+};
@@ -3,18 +3,26 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <functional>
 #include <string>
+#include <thread>
+#include <limits>
+#include <cstdint>
 
-const int TWO_OPT_ITERATIONS = 10;
+#include "aho_corasick.h"
+#include "alphabet.h"
+
+const int OR_OPT_MAX_SEGMENT = 3;
+const int DENSE_OVERLAP_MAX_STRINGS = 5000;
+const int SPARSE_OVERLAP_NEIGHBORS = 8;
+const int LOCAL_SEARCH_NEIGHBORS = 8;
+const int LOCAL_SEARCH_FULL_MAX_STRINGS = 2000;
+const int ASSIGNMENT_MAX_STRINGS = 5000;
+const int DP_WINDOW_SIZE = 14;
 
 struct Edge {
     int from;
     int to;
-    int weight;
-
-    bool operator<(const Edge& other) const {
-        return weight < other.weight;
-    }
 };
 
 class DSU {
@@ -61,69 +69,416 @@ private:
 };
 
 
-int CalculateOverlap(std::string_view s1, std::string_view s2) {
-    for (int overlap = std::min(s1.size(), s2.size()); overlap > 0; overlap--) {
-        if (s1.substr(s1.size() - overlap) == s2.substr(0, overlap)) {
-            return overlap;
+// A string is redundant if it occurs in the other strings more often than it has copies: reading all strings
+// through the automaton counts every occurrence in O(sum |s|). Of equal strings only the first copy is kept
+std::vector<std::string> RemoveSubstrings(std::vector<std::string> strings) {
+    std::sort(strings.begin(), strings.end(), [](const std::string& a, const std::string& b) {
+        return a.size() > b.size();
+    });
+
+    AhoCorasick automaton(strings);
+    std::vector<long long> occurrences(automaton.GetNodeCount());
+    for (const auto& string : strings) {
+        automaton.CountVisits(string, occurrences);
+    }
+    automaton.AccumulateOverFailLinks(occurrences);
+
+    std::vector<long long> copies(automaton.GetNodeCount());
+    for (int i = 0; i < (int)strings.size(); i++) {
+        copies[automaton.GetTerminal(i)]++;
+    }
+
+    std::vector<std::string> result;
+    for (int i = 0; i < (int)strings.size(); i++) {
+        int terminal = automaton.GetTerminal(i);
+        if (occurrences[terminal] == copies[terminal]) {
+            result.push_back(std::move(strings[i]));
+            copies[terminal] = -1;
         }
     }
 
-    return 0;
+    return result;
 }
 
-bool IsSubstring(const std::string& inner, const std::string& outer) {
-    if (inner.size() > outer.size()) {
-        return false;
+// Splits [0, n) into threadCount contiguous ranges and runs job(begin, end) on each of them in its own thread
+template <typename Job>
+void RunInParallel(int n, int threadCount, Job job) {
+    threadCount = std::max(1, std::min(threadCount, n));
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threadCount; t++) {
+        workers.emplace_back(job, (long long)n * t / threadCount, (long long)n * (t + 1) / threadCount);
+    }
+    job(0, n / threadCount);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// For every node, the strings having the node on the fail chain of their terminal: the node spells their suffix
+std::vector<std::vector<int>> ListSuffixes(const AhoCorasick& automaton, int n) {
+    std::vector<std::vector<int>> suffixesAt(automaton.GetNodeCount());
+    for (int i = 0; i < n; i++) {
+        for (int node = automaton.GetTerminal(i); node != 0; node = automaton.GetFail(node)) {
+            suffixesAt[node].push_back(i);
+        }
     }
 
-    return outer.find(inner) != std::string::npos;
+    return suffixesAt;
 }
 
-std::vector<std::string> RemoveSubstrings(std::vector<std::string> strings) {
-    std::sort(strings.begin(), strings.end(), [](const std::string& a, const std::string& b) {
-        return a.size() > b.size();
-    });
+// Rows [begin, end) of the flat n x n overlap matrix, written transposed: overlap[j * n + i] is the overlap
+// of strings[i] followed by strings[j]. Every node on the fail chain of the terminal of strings[i] spells a suffix
+// of it, so i is listed at each of them. A DFS over the trie keeps, for every string, a stack of the depths of such
+// nodes on the current path: at the terminal of strings[j] the top of the stack of i is the longest suffix of
+// strings[i] that is a prefix of strings[j]. O(sum |s| + n * (end - begin))
+void FillOverlapRows(const AhoCorasick& automaton, const std::vector<std::vector<int>>& suffixesAt, int n,
+                     int begin, int end, std::vector<uint16_t>& overlap) {
+    // Equal strings share a terminal, they are chained through sameTerminal
+    std::vector<int> terminalOf(automaton.GetNodeCount(), -1);
+    std::vector<int> sameTerminal(n, -1);
+    for (int j = 0; j < n; j++) {
+        sameTerminal[j] = terminalOf[automaton.GetTerminal(j)];
+        terminalOf[automaton.GetTerminal(j)] = j;
+    }
 
-    std::vector<bool> substring(strings.size());
-    for (int i = 0; i < strings.size(); i++) {
-        if (substring[i]) {
+    // top[i] duplicates the top of depths[i] in a flat array for the O(n) scans at terminals
+    std::vector<std::vector<int>> depths(n);
+    std::vector<int> top(n, 0);
+    std::vector<std::pair<int, bool>> stack = {{0, false}};
+    while (!stack.empty()) {
+        auto [node, leaving] = stack.back();
+        stack.pop_back();
+
+        if (leaving) {
+            for (int i : suffixesAt[node]) {
+                if (begin <= i && i < end) {
+                    depths[i].pop_back();
+                    top[i] = depths[i].empty() ? 0 : depths[i].back();
+                }
+            }
             continue;
         }
 
-        for (int j = i + 1; j < strings.size(); j++) {
-            if (!substring[j] && IsSubstring(strings[j], strings[i])) {
-                substring[j] = true;
+        for (int i : suffixesAt[node]) {
+            if (begin <= i && i < end) {
+                depths[i].push_back(automaton.GetDepth(node));
+                top[i] = depths[i].back();
             }
         }
+
+        for (int j = terminalOf[node]; j != -1; j = sameTerminal[j]) {
+            // Overlaps that do not fit into 16 bits are stored as 0, like in the sparse graph
+            for (int i = begin; i < end; i++) {
+                overlap[(size_t)j * n + i] = top[i] > std::numeric_limits<uint16_t>::max() ? 0 : top[i];
+            }
+            if (begin <= j && j < end) {
+                overlap[(size_t)j * n + j] = 0;
+            }
+        }
+
+        stack.push_back({node, true});
+        for (int child = automaton.GetFirstChild(node); child != -1; child = automaton.GetNextSibling(child)) {
+            stack.push_back({child, false});
+        }
     }
+}
 
-    std::vector<std::string> result;
-    for (int i = 0; i < strings.size(); i++) {
-        if (!substring[i]) {
-            result.push_back(std::move(strings[i]));
+// Strings with a nonzero overlap in front of string (strings[j]), each once at its largest overlap and largest
+// first, while callback(i, overlap) returns true. The trie path of the string spells its prefixes and the strings
+// listed at a node of it end with that prefix, so scanning the path from the deepest node meets every string first
+// at its longest overlap. path and seenBy are buffers reused between calls for different j
+template <typename Callback>
+void ScanPredecessors(const AhoCorasick& automaton, const std::vector<std::vector<int>>& suffixesAt,
+                      const std::string& string, int j, std::vector<int>& path, std::vector<int>& seenBy,
+                      Callback callback) {
+    path.clear();
+    int node = 0;
+    for (char c : string) {
+        node = automaton.Next(node, c);
+        path.push_back(node);
+    }
+
+    seenBy[j] = j;
+    for (int depth = path.size(); depth > 0; depth--) {
+        for (int i : suffixesAt[path[depth - 1]]) {
+            if (seenBy[i] == j) {
+                continue;
+            }
+
+            seenBy[i] = j;
+            if (!callback(i, depth)) {
+                return;
+            }
         }
     }
+}
 
-    return result;
+// For strings [begin, end), up to neighborCount other strings with the largest nonzero overlap in front of each.
+// Lists go to the slots [j * neighborCount, j * neighborCount + counts[j]), largest overlaps first
+void FillLargestPredecessors(const AhoCorasick& automaton, const std::vector<std::vector<int>>& suffixesAt,
+                             const std::vector<std::string>& strings, int neighborCount, int begin, int end,
+                             std::vector<int>& ids, std::vector<uint16_t>& overlaps, std::vector<int>& counts) {
+    std::vector<int> path;
+    std::vector<int> seenBy(strings.size(), -1);
+    for (int j = begin; j < end; j++) {
+        size_t slot = (size_t)j * neighborCount;
+        int count = 0;
+        ScanPredecessors(automaton, suffixesAt, strings[j], j, path, seenBy, [&](int i, int overlap) {
+            // Overlaps that do not fit into the 16-bit weights are left out
+            if (overlap > std::numeric_limits<uint16_t>::max()) {
+                return true;
+            }
+
+            ids[slot + count] = i;
+            overlaps[slot + count] = overlap;
+            return ++count < neighborCount;
+        });
+        counts[j] = count;
+    }
 }
 
-std::vector<std::vector<int>> BuildOverlapMatrix(const std::vector<std::string>& strings) {
-    std::vector<std::vector<int>> overlap(strings.size());
-    for (int i = 0; i < strings.size(); i++) {
-        overlap[i].resize(strings.size());
-        for (int j = 0; j < strings.size(); j++) {
-            if (i != j) {
-                overlap[i][j] = CalculateOverlap(strings[i], strings[j]);
+struct OverlapEdge {
+    int from;
+    int to;
+    int overlap;
+};
+
+// All-pairs suffix-prefix overlaps: Get(from, to) is the longest suffix of strings[from] that is a prefix
+// of strings[to]. Small sets keep the flat n x n matrix of 16-bit overlaps. With neighborCount > 0 only the largest
+// nonzero overlaps of every string are kept, as successors and as predecessors, in CSR arrays with 16-bit weights:
+// O(n * k) memory. Pairs left out (and overlaps over 65535) read as 0, which is still a valid overlap, so
+// superstrings built on either graph stay correct
+class OverlapGraph {
+public:
+    OverlapGraph(const std::vector<std::string>& strings, int neighborCount, int threadCount)
+        : N_(strings.size())
+        , NeighborCount_(neighborCount)
+    {
+        if (neighborCount > 0) {
+            BuildSparse(strings, threadCount);
+        } else {
+            BuildDense(strings, threadCount);
+        }
+    }
+
+    // Sparse graph of exactly the given overlaps, for strings that were not all compared with each other
+    OverlapGraph(int n, std::vector<OverlapEdge> edges)
+        : N_(n)
+        , NeighborCount_(-1)
+    {
+        auto byOverlap = [](const OverlapEdge& a, const OverlapEdge& b) {
+            return a.overlap > b.overlap;
+        };
+        std::stable_sort(edges.begin(), edges.end(), byOverlap);
+        edges.erase(std::remove_if(edges.begin(), edges.end(), [](const OverlapEdge& edge) {
+            return edge.overlap <= 0 || edge.overlap > std::numeric_limits<uint16_t>::max();
+        }), edges.end());
+
+        Successors_ = BuildLists(edges, true);
+        Predecessors_ = BuildLists(edges, false);
+    }
+
+    int GetSize() const {
+        return N_;
+    }
+
+    int Get(int from, int to) const {
+        if (NeighborCount_ == 0) {
+            return Dense_[(size_t)from * N_ + to];
+        }
+
+        for (int e = Successors_.Offset[from]; e < Successors_.Offset[from + 1]; e++) {
+            if (Successors_.Ids[e] == to) {
+                return Successors_.Overlaps[e];
             }
         }
+        for (int e = Predecessors_.Offset[to]; e < Predecessors_.Offset[to + 1]; e++) {
+            if (Predecessors_.Ids[e] == from) {
+                return Predecessors_.Overlaps[e];
+            }
+        }
+
+        return 0;
     }
 
-    return overlap;
-}
+    // callback(to, overlap) for the strings kept after strings[from] with a nonzero overlap
+    template <typename Callback>
+    void ForEachSuccessor(int from, Callback callback) const {
+        if (NeighborCount_ == 0) {
+            for (int to = 0; to < N_; to++) {
+                int overlap = Dense_[(size_t)from * N_ + to];
+                if (overlap > 0) {
+                    callback(to, overlap);
+                }
+            }
+            return;
+        }
+
+        for (int e = Successors_.Offset[from]; e < Successors_.Offset[from + 1]; e++) {
+            callback(Successors_.Ids[e], (int)Successors_.Overlaps[e]);
+        }
+    }
+
+    // callback(from, overlap) for the strings kept before strings[to] with a nonzero overlap
+    template <typename Callback>
+    void ForEachPredecessor(int to, Callback callback) const {
+        if (NeighborCount_ == 0) {
+            for (int from = 0; from < N_; from++) {
+                int overlap = Dense_[(size_t)from * N_ + to];
+                if (overlap > 0) {
+                    callback(from, overlap);
+                }
+            }
+            return;
+        }
+
+        for (int e = Predecessors_.Offset[to]; e < Predecessors_.Offset[to + 1]; e++) {
+            callback(Predecessors_.Ids[e], (int)Predecessors_.Overlaps[e]);
+        }
+    }
+
+    // callback(from, to, overlap) for every kept nonzero overlap. In the sparse graph a pair kept in both
+    // directions is reported twice
+    template <typename Callback>
+    void ForEachEdge(Callback callback) const {
+        for (int from = 0; from < N_; from++) {
+            ForEachSuccessor(from, [&](int to, int overlap) {
+                callback(from, to, overlap);
+            });
+        }
+
+        if (NeighborCount_ != 0) {
+            for (int to = 0; to < N_; to++) {
+                ForEachPredecessor(to, [&](int from, int overlap) {
+                    callback(from, to, overlap);
+                });
+            }
+        }
+    }
+
+private:
+    struct CsrLists {
+        std::vector<int> Offset;
+        std::vector<int> Ids;
+        std::vector<uint16_t> Overlaps;
+    };
+
+    void BuildDense(const std::vector<std::string>& strings, int threadCount) {
+        AhoCorasick automaton(strings);
+        auto suffixesAt = ListSuffixes(automaton, N_);
+
+        Dense_.assign((size_t)N_ * N_, 0);
+        RunInParallel(N_, threadCount, [&](int begin, int end) {
+            FillOverlapRows(automaton, suffixesAt, N_, begin, end, Dense_);
+        });
+
+        // In-place transposition block by block: the rows filled above are written contiguously, the columns would not be
+        const int BLOCK_SIZE = 64;
+        for (int rowBlock = 0; rowBlock < N_; rowBlock += BLOCK_SIZE) {
+            for (int columnBlock = rowBlock; columnBlock < N_; columnBlock += BLOCK_SIZE) {
+                for (int i = rowBlock; i < std::min(N_, rowBlock + BLOCK_SIZE); i++) {
+                    for (int j = std::max(columnBlock, i + 1); j < std::min(N_, columnBlock + BLOCK_SIZE); j++) {
+                        std::swap(Dense_[(size_t)i * N_ + j], Dense_[(size_t)j * N_ + i]);
+                    }
+                }
+            }
+        }
+    }
+
+    // Predecessors come from the automaton of the strings, successors from the automaton of the reversed strings:
+    // a suffix of a that is a prefix of b, reversed, is a prefix of reversed a and a suffix of reversed b
+    void BuildSparse(const std::vector<std::string>& strings, int threadCount) {
+        Predecessors_ = BuildLargestPredecessors(strings, threadCount);
+
+        std::vector<std::string> reversed = strings;
+        for (auto& string : reversed) {
+            std::reverse(string.begin(), string.end());
+        }
+        Successors_ = BuildLargestPredecessors(reversed, threadCount);
+    }
+
+    // Lists of the edges grouped by their source or by their target, keeping the order of the edges. A pair given
+    // twice is kept once
+    CsrLists BuildLists(const std::vector<OverlapEdge>& edges, bool bySource) const {
+        CsrLists lists;
+        lists.Offset.assign(N_ + 1, 0);
+        for (const auto& edge : edges) {
+            lists.Offset[(bySource ? edge.from : edge.to) + 1]++;
+        }
+        for (int v = 0; v < N_; v++) {
+            lists.Offset[v + 1] += lists.Offset[v];
+        }
+
+        std::vector<int> filled(lists.Offset.begin(), lists.Offset.end() - 1);
+        lists.Ids.resize(edges.size());
+        lists.Overlaps.resize(edges.size());
+        for (const auto& edge : edges) {
+            int v = bySource ? edge.from : edge.to;
+            lists.Ids[filled[v]] = bySource ? edge.to : edge.from;
+            lists.Overlaps[filled[v]++] = edge.overlap;
+        }
+
+        // Duplicates are dropped in place, the offsets shrink accordingly
+        std::vector<int> seenBy(N_, -1);
+        int size = 0;
+        for (int v = 0; v < N_; v++) {
+            int begin = lists.Offset[v];
+            lists.Offset[v] = size;
+            for (int e = begin; e < filled[v]; e++) {
+                if (seenBy[lists.Ids[e]] != v) {
+                    seenBy[lists.Ids[e]] = v;
+                    lists.Ids[size] = lists.Ids[e];
+                    lists.Overlaps[size++] = lists.Overlaps[e];
+                }
+            }
+        }
+        lists.Offset[N_] = size;
+        lists.Ids.resize(size);
+        lists.Overlaps.resize(size);
+
+        return lists;
+    }
+
+    CsrLists BuildLargestPredecessors(const std::vector<std::string>& strings, int threadCount) const {
+        AhoCorasick automaton(strings);
+        auto suffixesAt = ListSuffixes(automaton, N_);
+
+        std::vector<int> ids((size_t)N_ * NeighborCount_);
+        std::vector<uint16_t> overlaps((size_t)N_ * NeighborCount_);
+        std::vector<int> counts(N_);
+        RunInParallel(N_, threadCount, [&](int begin, int end) {
+            FillLargestPredecessors(automaton, suffixesAt, strings, NeighborCount_, begin, end, ids, overlaps, counts);
+        });
+
+        CsrLists lists;
+        lists.Offset.assign(N_ + 1, 0);
+        for (int j = 0; j < N_; j++) {
+            lists.Offset[j + 1] = lists.Offset[j] + counts[j];
+        }
+
+        lists.Ids.resize(lists.Offset[N_]);
+        lists.Overlaps.resize(lists.Offset[N_]);
+        for (int j = 0; j < N_; j++) {
+            size_t slot = (size_t)j * NeighborCount_;
+            std::copy(ids.begin() + slot, ids.begin() + slot + counts[j], lists.Ids.begin() + lists.Offset[j]);
+            std::copy(overlaps.begin() + slot, overlaps.begin() + slot + counts[j],
+                      lists.Overlaps.begin() + lists.Offset[j]);
+        }
+
+        return lists;
+    }
+
+    int N_;
+    // 0 for the dense matrix, -1 for a graph of given edges
+    int NeighborCount_;
+    std::vector<uint16_t> Dense_;
+    CsrLists Successors_;
+    CsrLists Predecessors_;
+};
 
 int CalculateSuperstringLength(const std::vector<std::string>& strings,
                                 const std::vector<int>& order,
-                                const std::vector<std::vector<int>>& overlap) {
+                                const OverlapGraph& overlap) {
     if (order.empty()) {
         return 0;
     }
@@ -132,7 +487,7 @@ int CalculateSuperstringLength(const std::vector<std::string>& strings,
     for (int i = 1; i < order.size(); i++) {
         int prev = order[i - 1];
         int curr = order[i];
-        length += strings[curr].size() - overlap[prev][curr];
+        length += strings[curr].size() - overlap.Get(prev, curr);
     }
     
     return length;
@@ -140,7 +495,7 @@ int CalculateSuperstringLength(const std::vector<std::string>& strings,
 
 std::string BuildSuperstring(const std::vector<std::string>& strings,
                              const std::vector<int>& order,
-                             const std::vector<std::vector<int>>& overlap) {
+                             const OverlapGraph& overlap) {
     if (order.empty()) {
         return "";
     }
@@ -150,13 +505,16 @@ std::string BuildSuperstring(const std::vector<std::string>& strings,
     for (int i = 1; i < order.size(); i++) {
         int prev = order[i - 1];
         int curr = order[i];
-        result << strings[curr].substr(overlap[prev][curr]);
+        result << strings[curr].substr(overlap.Get(prev, curr));
     }
 
     return result.str();
 }
 
-std::vector<int> GreedySuperstring(const std::vector<std::string>& strings, const std::vector<std::vector<int>>& overlap) {
+// Greedy merging: strings are joined into chains by the largest overlaps first. next can hold chains to start from,
+// next[i] = -1 where strings[i] has no successor yet
+std::vector<int> GreedySuperstring(const std::vector<std::string>& strings, const OverlapGraph& overlap,
+                                   std::vector<int> next = {}) {
     if (strings.size() == 0) {
         return {};
     }
@@ -164,27 +522,44 @@ std::vector<int> GreedySuperstring(const std::vector<std::string>& strings, cons
         return {0};
     }
 
-    std::vector<int> next(strings.size(), -1);
-    std::vector<int> prev(strings.size(), -1);
-    
-    DSU classes(strings.size());
+    int n = strings.size();
+    next.resize(n, -1);
+    std::vector<int> prev(n, -1);
 
-    // Build full graph of edges with cost = overlap[from][to]
-    std::vector<Edge> edges;
-    for (int from = 0; from < strings.size(); from++) {
-        for (int to = 0; to < strings.size(); to++) {
-            if (from != to) {
-                edges.push_back({from, to, overlap[from][to]});
-            }
+    DSU classes(n);
+    int edgesAdded = 0;
+    for (int from = 0; from < n; from++) {
+        if (next[from] != -1) {
+            prev[next[from]] = from;
+            classes.Unite(from, next[from]);
+            edgesAdded++;
         }
     }
 
-    // Unite strings into chains in greedy way
-    std::sort(edges.begin(), edges.end());
+    // Counting sort of the nonzero overlaps by length: an overlap is shorter than both strings,
+    // so lengths are bounded by the longest string. Zero overlaps never join chains
+    int maxOverlap = 0;
+    for (const auto& s : strings) {
+        maxOverlap = std::max(maxOverlap, (int)s.size());
+    }
 
-    int edgesAdded = 0;
+    std::vector<int> bucketStart(maxOverlap + 2, 0);
+    overlap.ForEachEdge([&](int, int, int weight) {
+        bucketStart[maxOverlap - weight + 1]++;
+    });
+    for (int w = 1; w <= maxOverlap + 1; w++) {
+        bucketStart[w] += bucketStart[w - 1];
+    }
+
+    // Largest overlaps first
+    std::vector<Edge> edges(bucketStart[maxOverlap + 1]);
+    overlap.ForEachEdge([&](int from, int to, int weight) {
+        edges[bucketStart[maxOverlap - weight]++] = {from, to};
+    });
+
+    // Unite strings into chains in greedy way
     for (const auto& e : edges) {
-        if (edgesAdded + 1 >= strings.size()) {
+        if (edgesAdded + 1 >= n) {
             break;
         }
 
@@ -222,62 +597,633 @@ std::vector<int> GreedySuperstring(const std::vector<std::string>& strings, cons
     return order;
 }
 
-void TwoOptOptimization(std::vector<int>& order,
-                        const std::vector<std::string>& strings,
-                        const std::vector<std::vector<int>>& overlap) {
-    if (order.size() < 3) {
-        return;
+// Maximum total overlap assignment: successor[i] != i for every string and every string is the successor of exactly
+// one. Its overlap bounds the overlap of any order, which is a path in the same graph. Hungarian algorithm with
+// potentials on costs -overlap: O(n^3) time, O(n) memory besides the dense matrix
+std::vector<int> MaxOverlapAssignment(const OverlapGraph& overlap) {
+    int n = overlap.GetSize();
+    const long long FORBIDDEN = std::numeric_limits<int>::max();
+    const long long INF = std::numeric_limits<long long>::max() / 4;
+
+    // Rows and columns are 1-based, column 0 holds the row being added
+    std::vector<long long> rowPotential(n + 1), columnPotential(n + 1), minSlack(n + 1);
+    std::vector<int> rowOf(n + 1), way(n + 1);
+    std::vector<bool> used(n + 1);
+    for (int row = 1; row <= n; row++) {
+        rowOf[0] = row;
+        int column = 0;
+        std::fill(minSlack.begin(), minSlack.end(), INF);
+        std::fill(used.begin(), used.end(), false);
+
+        // Dijkstra-like search for the cheapest augmenting path from the new row to a free column
+        do {
+            used[column] = true;
+            int from = rowOf[column];
+            long long delta = INF;
+            int nextColumn = 0;
+            for (int to = 1; to <= n; to++) {
+                if (used[to]) {
+                    continue;
+                }
+
+                long long cost = from == to ? FORBIDDEN : -overlap.Get(from - 1, to - 1);
+                long long slack = cost - rowPotential[from] - columnPotential[to];
+                if (slack < minSlack[to]) {
+                    minSlack[to] = slack;
+                    way[to] = column;
+                }
+                if (minSlack[to] < delta) {
+                    delta = minSlack[to];
+                    nextColumn = to;
+                }
+            }
+
+            for (int to = 0; to <= n; to++) {
+                if (used[to]) {
+                    rowPotential[rowOf[to]] += delta;
+                    columnPotential[to] -= delta;
+                } else {
+                    minSlack[to] -= delta;
+                }
+            }
+            column = nextColumn;
+        } while (rowOf[column] != 0);
+
+        do {
+            int previous = way[column];
+            rowOf[column] = rowOf[previous];
+            column = previous;
+        } while (column != 0);
+    }
+
+    std::vector<int> successor(n);
+    for (int column = 1; column <= n; column++) {
+        successor[rowOf[column] - 1] = column - 1;
+    }
+
+    return successor;
+}
+
+// Cycle cover construction in the style of Mgreedy: every cycle of the assignment is cut at its smallest overlap,
+// the resulting chains are then merged greedily
+std::vector<int> CycleCoverSuperstring(const std::vector<std::string>& strings, const OverlapGraph& overlap,
+                                       const std::vector<int>& successor) {
+    int n = strings.size();
+    std::vector<int> next = successor;
+    std::vector<bool> visited(n, false);
+    for (int start = 0; start < n; start++) {
+        if (visited[start]) {
+            continue;
+        }
+
+        int weakest = start;
+        for (int v = start; !visited[v]; v = successor[v]) {
+            visited[v] = true;
+            if (overlap.Get(v, successor[v]) < overlap.Get(weakest, successor[weakest])) {
+                weakest = v;
+            }
+        }
+        next[weakest] = -1;
     }
 
-    bool improved = true;
-    for (int iteration = 0; improved && iteration < TWO_OPT_ITERATIONS; iteration++) {
-        improved = false;
+    return GreedySuperstring(strings, overlap, next);
+}
 
-        int bestLength = CalculateSuperstringLength(strings, order, overlap);
-        for (int i = 0; i + 1 < order.size() && !improved; i++) {
-            for (int j = i + 2; j < order.size() && !improved; j++) {
-                std::vector<int> newOrder = order;
-                std::reverse(newOrder.begin() + i + 1, newOrder.begin() + j + 1);
+// 2-opt and Or-opt over the string order. The superstring length is sum |s| minus the overlaps of adjacent strings,
+// so moves are scored by the change of the total overlap in O(1): reversing a segment turns its inner overlaps
+// around, their sums in both directions come from prefix sums. With candidateCount = k > 0 only moves joining a
+// string with one of its k largest successors or predecessors (or touching an end of the order) are tried, so a
+// sweep costs O(n * k) for both the dense and the sparse graph; with 0 every segment end and every position are
+// tried, O(n^2) per sweep. Moves are applied in place, every sweep takes the best move for each segment start and
+// goes on, until a whole sweep finds nothing
+class LocalSearch {
+public:
+    LocalSearch(const OverlapGraph& overlap, int candidateCount)
+        : Overlap_(overlap)
+        , Full_(candidateCount == 0)
+        , Successors_(overlap.GetSize())
+        , Predecessors_(overlap.GetSize())
+    {
+        if (Full_) {
+            return;
+        }
 
-                if (CalculateSuperstringLength(strings, newOrder, overlap) < bestLength) {
-                    improved = true;
-                    order = newOrder;
+        // One row-major pass over the edges: (from, to) is offered to the successors of from and to the
+        // predecessors of to. Each list is a min-heap of the k largest (overlap, id) pairs seen so far
+        int n = overlap.GetSize();
+        std::vector<std::vector<std::pair<int, int>>> largestSuccessors(n);
+        std::vector<std::vector<std::pair<int, int>>> largestPredecessors(n);
+        auto offer = [&](std::vector<std::pair<int, int>>& heap, int weight, int id) {
+            std::pair<int, int> candidate = {weight, id};
+            if ((int)heap.size() == candidateCount && candidate <= heap.front()) {
+                return;
+            }
+            // The sparse graph reports a pair kept in both directions twice
+            if (std::find(heap.begin(), heap.end(), candidate) != heap.end()) {
+                return;
+            }
+
+            if ((int)heap.size() == candidateCount) {
+                std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+                heap.pop_back();
+            }
+            heap.push_back(candidate);
+            std::push_heap(heap.begin(), heap.end(), std::greater<>());
+        };
+
+        overlap.ForEachEdge([&](int from, int to, int weight) {
+            offer(largestSuccessors[from], weight, to);
+            offer(largestPredecessors[to], weight, from);
+        });
+
+        auto keepLargest = [](std::vector<std::pair<int, int>>& heap, std::vector<int>& neighbors) {
+            std::sort_heap(heap.begin(), heap.end(), std::greater<>());
+            for (auto [weight, id] : heap) {
+                neighbors.push_back(id);
+            }
+        };
+        for (int v = 0; v < n; v++) {
+            keepLargest(largestSuccessors[v], Successors_[v]);
+            keepLargest(largestPredecessors[v], Predecessors_[v]);
+        }
+    }
+
+    // Sweeps over the whole order, or, with active strings given, starts segments only at them and at the strings
+    // around the moves made since
+    void Optimize(std::vector<int>& order, const std::vector<int>& active = {}) {
+        int n = order.size();
+        if (n < 3) {
+            return;
+        }
+
+        Order_ = &order;
+        Position_.resize(n);
+        Forward_.resize(n);
+        Backward_.resize(n);
+        Update(0);
+
+        if (active.empty()) {
+            bool improved = true;
+            while (improved) {
+                improved = false;
+                for (int i = 0; i < n; i++) {
+                    if (ImproveAt(i)) {
+                        improved = true;
+                    }
+                }
+            }
+        } else {
+            std::vector<int> queue = active;
+            std::vector<bool> queued(Overlap_.GetSize(), false);
+            for (int v : queue) {
+                queued[v] = true;
+            }
+
+            while (!queue.empty()) {
+                int v = queue.back();
+                queue.pop_back();
+                queued[v] = false;
+                if (!ImproveAt(Position_[v])) {
+                    continue;
+                }
+
+                for (int position : Touched_) {
+                    if (0 <= position && position < n && !queued[order[position]]) {
+                        queued[order[position]] = true;
+                        queue.push_back(order[position]);
+                    }
+                }
+            }
+        }
+
+        Order_ = nullptr;
+    }
+
+private:
+    // Overlap between the strings at positions a and b, 0 if either is outside of the order
+    int OverlapAt(int a, int b) const {
+        int n = Order_->size();
+        if (a < 0 || b < 0 || a >= n || b >= n) {
+            return 0;
+        }
+
+        return Overlap_.Get((*Order_)[a], (*Order_)[b]);
+    }
+
+    // Positions of the strings from position from on and the prefix sums depending on them:
+    // Forward_[k] and Backward_[k] sum overlaps of the pairs (t, t + 1) for t < k, read left to right and right to left
+    void Update(int from) {
+        const auto& order = *Order_;
+        for (int k = from; k < (int)order.size(); k++) {
+            Position_[order[k]] = k;
+        }
+
+        Forward_[0] = 0;
+        Backward_[0] = 0;
+        for (int k = std::max(from, 1); k < (int)order.size(); k++) {
+            Forward_[k] = Forward_[k - 1] + Overlap_.Get(order[k - 1], order[k]);
+            Backward_[k] = Backward_[k - 1] + Overlap_.Get(order[k], order[k - 1]);
+        }
+    }
+
+    // Change of the inner overlaps of segment [first, last] when it is reversed
+    long long ReversalGain(int first, int last) const {
+        return (Backward_[last] - Backward_[first]) - (Forward_[last] - Forward_[first]);
+    }
+
+    long long TwoOptGain(int first, int last) const {
+        return OverlapAt(first - 1, last) + OverlapAt(first, last + 1)
+               - OverlapAt(first - 1, first) - OverlapAt(last, last + 1)
+               + ReversalGain(first, last);
+    }
+
+    // Segment [first, last] moved between positions p and p + 1
+    long long OrOptGain(int first, int last, int p, bool reversed) const {
+        long long gain = OverlapAt(first - 1, last + 1) - OverlapAt(first - 1, first) - OverlapAt(last, last + 1);
+        gain -= OverlapAt(p, p + 1);
+        if (reversed) {
+            gain += OverlapAt(p, last) + OverlapAt(first, p + 1) + ReversalGain(first, last);
+        } else {
+            gain += OverlapAt(p, first) + OverlapAt(last, p + 1);
+        }
+
+        return gain;
+    }
+
+    bool ImproveAt(int first) {
+        auto& order = *Order_;
+        int n = order.size();
+
+        long long bestGain = 0;
+        int bestLast = -1;
+        int bestPosition = -1;
+        bool bestReversed = false;
+        bool bestIsOrOpt = false;
+
+        // Reversal of [first, last] joins order[first - 1] with order[last] and order[first] with order[last + 1]
+        auto tryTwoOpt = [&](int last) {
+            if (last <= first || last >= n) {
+                return;
+            }
+
+            long long gain = TwoOptGain(first, last);
+            if (gain > bestGain) {
+                bestGain = gain;
+                bestLast = last;
+                bestIsOrOpt = false;
+            }
+        };
+
+        if (Full_) {
+            for (int last = first + 1; last < n; last++) {
+                tryTwoOpt(last);
+            }
+        }
+        if (first > 0) {
+            for (int to : Successors_[order[first - 1]]) {
+                tryTwoOpt(Position_[to]);
+            }
+        }
+        for (int to : Successors_[order[first]]) {
+            tryTwoOpt(Position_[to] - 1);
+        }
+        tryTwoOpt(n - 1);
+
+        for (int last = first; last < std::min(n, first + OR_OPT_MAX_SEGMENT); last++) {
+            auto tryOrOpt = [&](int p) {
+                if (p < -1 || p >= n || (first - 1 <= p && p <= last)) {
+                    return;
+                }
+
+                for (bool reversed : {false, true}) {
+                    long long gain = OrOptGain(first, last, p, reversed);
+                    if (gain > bestGain) {
+                        bestGain = gain;
+                        bestLast = last;
+                        bestPosition = p;
+                        bestReversed = reversed;
+                        bestIsOrOpt = true;
+                    }
+                }
+            };
+
+            if (Full_) {
+                for (int p = -1; p < n; p++) {
+                    tryOrOpt(p);
+                }
+            }
+
+            // The segment lands right after a predecessor or right before a successor of one of its ends
+            for (int end : {order[first], order[last]}) {
+                for (int from : Predecessors_[end]) {
+                    tryOrOpt(Position_[from]);
+                }
+                for (int to : Successors_[end]) {
+                    tryOrOpt(Position_[to] - 1);
+                }
+            }
+            tryOrOpt(-1);
+            tryOrOpt(n - 1);
+        }
+
+        if (bestGain == 0) {
+            return false;
+        }
+
+        if (!bestIsOrOpt) {
+            std::reverse(order.begin() + first, order.begin() + bestLast + 1);
+            Update(first);
+            Touched_ = {first - 1, first, bestLast, bestLast + 1};
+            return true;
+        }
+
+        int length = bestLast - first + 1;
+        int newFirst = bestPosition + 1;
+        if (bestPosition < first) {
+            std::rotate(order.begin() + bestPosition + 1, order.begin() + first, order.begin() + bestLast + 1);
+        } else {
+            std::rotate(order.begin() + first, order.begin() + bestLast + 1, order.begin() + bestPosition + 1);
+            newFirst = bestPosition - length + 1;
+        }
+
+        if (bestReversed) {
+            std::reverse(order.begin() + newFirst, order.begin() + newFirst + length);
+        }
+
+        Update(std::min(first, newFirst));
+        // Ends of the moved segment and of the gap it left
+        int gap = bestPosition < first ? bestLast : first - 1;
+        Touched_ = {newFirst - 1, newFirst, newFirst + length - 1, newFirst + length, gap, gap + 1};
+        return true;
+    }
+
+    const OverlapGraph& Overlap_;
+    bool Full_;
+    std::vector<std::vector<int>> Successors_;
+    std::vector<std::vector<int>> Predecessors_;
+    std::vector<int>* Order_ = nullptr;
+    std::vector<int> Position_;
+    std::vector<long long> Forward_;
+    std::vector<long long> Backward_;
+    // Positions next to which the last applied move changed adjacencies
+    std::vector<int> Touched_;
+};
+
+// Best order of the strings strictly inside positions [first, last] of the window, the strings at first and last
+// stay. first = -1 or last = order.size() leave that end of the window free. Held-Karp DP over subsets,
+// best[mask][end] is the largest overlap of a path from order[first] through the inner strings in mask ending
+// at inner string end. Overlaps of the window are copied to a small matrix first, the sparse graph would scan
+// its lists for each of the O(2^m * m^2) lookups. Returns true if the window was improved
+bool SolveWindow(std::vector<int>& order, const OverlapGraph& overlap, int first, int last, std::vector<int>& best) {
+    int m = last - first - 1;
+    if (m < 2) {
+        return false;
+    }
+
+    const int* inner = order.data() + first + 1;
+    std::vector<int> between(m * m), fromStart(m, 0), toEnd(m, 0);
+    for (int i = 0; i < m; i++) {
+        if (first >= 0) {
+            fromStart[i] = overlap.Get(order[first], inner[i]);
+        }
+        if (last < (int)order.size()) {
+            toEnd[i] = overlap.Get(inner[i], order[last]);
+        }
+        for (int j = 0; j < m; j++) {
+            between[i * m + j] = overlap.Get(inner[i], inner[j]);
+        }
+    }
+
+    int full = (1 << m) - 1;
+    std::fill(best.begin(), best.begin() + ((size_t)m << m), -1);
+    auto at = [&](int mask, int end) -> int& {
+        return best[(size_t)mask * m + end];
+    };
+
+    for (int end = 0; end < m; end++) {
+        at(1 << end, end) = fromStart[end];
+    }
+    for (int mask = 1; mask <= full; mask++) {
+        for (int end = 0; end < m; end++) {
+            int value = at(mask, end);
+            if (value < 0) {
+                continue;
+            }
+
+            for (int next = 0; next < m; next++) {
+                if (!(mask >> next & 1)) {
+                    int& target = at(mask | 1 << next, next);
+                    target = std::max(target, value + between[end * m + next]);
                 }
             }
         }
     }
+
+    int current = fromStart[0] + toEnd[m - 1];
+    for (int i = 0; i + 1 < m; i++) {
+        current += between[i * m + i + 1];
+    }
+
+    int bestValue = -1;
+    int bestEnd = -1;
+    for (int end = 0; end < m; end++) {
+        int value = at(full, end) + toEnd[end];
+        if (value > bestValue) {
+            bestValue = value;
+            bestEnd = end;
+        }
+    }
+    if (bestValue <= current) {
+        return false;
+    }
+
+    // Walk back through the table: the previous end is the one the best value came from
+    std::vector<int> path(m);
+    int mask = full;
+    int end = bestEnd;
+    for (int k = m - 1; k >= 0; k--) {
+        path[k] = inner[end];
+        int value = at(mask, end);
+        int previousMask = mask ^ 1 << end;
+        if (previousMask == 0) {
+            break;
+        }
+
+        for (int previous = 0; previous < m; previous++) {
+            if ((previousMask >> previous & 1) && at(previousMask, previous) >= 0
+                && at(previousMask, previous) + between[previous * m + end] == value) {
+                end = previous;
+                break;
+            }
+        }
+        mask = previousMask;
+    }
+
+    std::copy(path.begin(), path.end(), order.begin() + first + 1);
+    return true;
 }
 
-void SwapOptimization(std::vector<int>& order,
-                       const std::vector<std::string>& strings,
-                       const std::vector<std::vector<int>>& overlap) {
-    if (order.size() < 3) {
+// Exact re-ordering of windows of windowSize consecutive strings. Neighboring windows share only their fixed end
+// strings, so all windows of a round are solved in parallel; the next round shifts them by half a window.
+// Windows tile positions -1..n, the first and the last one have a free end, so the ends of the order move too.
+// Stops when two rounds in a row improve nothing, every window is then optimal for both shifts
+void WindowOptimization(std::vector<int>& order, const OverlapGraph& overlap, int windowSize, int threadCount) {
+    int n = order.size();
+    int step = windowSize - 1;
+    if (n < 2 || step < 3) {
         return;
     }
 
-    bool improved = true;
-    while (improved) {
-        improved = false;
+    int roundsWithoutImprovement = 0;
+    for (int round = 0; roundsWithoutImprovement < 2; round++) {
+        int offset = round % 2 == 0 ? 0 : step / 2;
+        int windowCount = (n + 1 - offset + step - 1) / step;
 
-        int bestLength = CalculateSuperstringLength(strings, order, overlap);
-        for (int i = 0; i < order.size() && !improved; i++) {
-            std::vector<int> newOrder = order;
-            newOrder.erase(newOrder.begin() + i);
+        std::vector<char> improved(windowCount, false);
+        RunInParallel(windowCount, threadCount, [&](int begin, int end) {
+            std::vector<int> best((size_t)(windowSize - 2) << (windowSize - 2));
+            for (int w = begin; w < end; w++) {
+                int first = offset + w * step - 1;
+                improved[w] = SolveWindow(order, overlap, first, std::min(n, first + step), best);
+            }
+        });
 
-            for (int j = 0; j <= newOrder.size() && !improved; j++) {
-                std::vector<int> testOrder = newOrder;
-                testOrder.insert(testOrder.begin() + j, order[i]);
+        bool anyImproved = std::find(improved.begin(), improved.end(), true) != improved.end();
+        roundsWithoutImprovement = anyImproved ? 0 : roundsWithoutImprovement + 1;
+    }
+}
 
-                if (CalculateSuperstringLength(strings, testOrder, overlap) < bestLength) {
-                    order = testOrder;
-                    improved = true;
-                }
+// Update of the previous superstring after strings were added to the input. Strings occurring in it keep the order
+// of their first occurrences, the overlap of neighbors is read off their positions. Only the other strings are
+// compared with all: their overlaps in both directions come from the automata of the strings and of the reversed
+// strings in O(|t| + number of overlapping strings) each, and each is inserted where it adds the least.
+// Fills edges with the overlaps the order relies on plus the largest ones of the inserted strings
+std::vector<int> IncrementalOrder(const std::vector<std::string>& strings, const std::string& previous,
+                                  std::vector<OverlapEdge>& edges, std::vector<int>& inserted) {
+    int n = strings.size();
+    AhoCorasick automaton(strings);
+    auto firstEnd = automaton.FindFirstOccurrences(previous);
+
+    std::vector<int> order;
+    for (int i = 0; i < n; i++) {
+        if (firstEnd[automaton.GetTerminal(i)] != -1) {
+            order.push_back(i);
+        } else {
+            inserted.push_back(i);
+        }
+    }
+
+    // No string is a substring of another, so strings ending earlier also start earlier
+    auto endOf = [&](int i) {
+        return firstEnd[automaton.GetTerminal(i)];
+    };
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return endOf(a) < endOf(b);
+    });
+
+    // adjacent[p] is the overlap of order[p] and order[p + 1]
+    std::vector<int> adjacent;
+    for (int p = 0; p + 1 < (int)order.size(); p++) {
+        long long nextStart = endOf(order[p + 1]) - (long long)strings[order[p + 1]].size() + 1;
+        adjacent.push_back(std::max(0LL, endOf(order[p]) - nextStart + 1));
+    }
+
+    auto suffixesAt = ListSuffixes(automaton, n);
+    std::vector<std::string> reversed = strings;
+    for (auto& string : reversed) {
+        std::reverse(string.begin(), string.end());
+    }
+    AhoCorasick reversedAutomaton(reversed);
+    auto reversedSuffixesAt = ListSuffixes(reversedAutomaton, n);
+
+    std::vector<int> into(n, 0), outOf(n, 0);
+    std::vector<int> path, seenBefore(n, -1), seenAfter(n, -1), touched;
+    for (int t : inserted) {
+        int kept = 0;
+        ScanPredecessors(automaton, suffixesAt, strings[t], t, path, seenBefore, [&](int i, int overlap) {
+            into[i] = overlap;
+            touched.push_back(i);
+            if (kept++ < SPARSE_OVERLAP_NEIGHBORS) {
+                edges.push_back({i, t, overlap});
+            }
+            return true;
+        });
+
+        kept = 0;
+        ScanPredecessors(reversedAutomaton, reversedSuffixesAt, reversed[t], t, path, seenAfter,
+                         [&](int i, int overlap) {
+            outOf[i] = overlap;
+            touched.push_back(i);
+            if (kept++ < SPARSE_OVERLAP_NEIGHBORS) {
+                edges.push_back({t, i, overlap});
+            }
+            return true;
+        });
+
+        // Position p means between order[p] and order[p + 1], -1 is the front
+        int m = order.size();
+        int bestPosition = m - 1;
+        int bestGain = m == 0 ? 0 : into[order[m - 1]];
+        if (m > 0 && outOf[order[0]] > bestGain) {
+            bestPosition = -1;
+            bestGain = outOf[order[0]];
+        }
+        for (int p = 0; p + 1 < m; p++) {
+            int gain = into[order[p]] + outOf[order[p + 1]] - adjacent[p];
+            if (gain > bestGain) {
+                bestPosition = p;
+                bestGain = gain;
+            }
+        }
+
+        if (m > 0) {
+            if (bestPosition == -1) {
+                adjacent.insert(adjacent.begin(), outOf[order[0]]);
+            } else if (bestPosition == m - 1) {
+                adjacent.push_back(into[order[m - 1]]);
+            } else {
+                adjacent[bestPosition] = into[order[bestPosition]];
+                adjacent.insert(adjacent.begin() + bestPosition + 1, outOf[order[bestPosition + 1]]);
             }
         }
+        order.insert(order.begin() + bestPosition + 1, t);
+
+        for (int i : touched) {
+            into[i] = 0;
+            outOf[i] = 0;
+        }
+        touched.clear();
     }
+
+    for (int p = 0; p + 1 < (int)order.size(); p++) {
+        edges.push_back({order[p], order[p + 1], adjacent[p]});
+    }
+
+    return order;
 }
 
-int main() {
+int main(int argc, char** argv) {
+    int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    int neighborCount = -1;
+    int searchNeighborCount = -1;
+    bool incremental = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--threads=", 0) == 0) {
+            threadCount = std::max(1, std::atoi(arg.c_str() + std::string("--threads=").size()));
+        } else if (arg.rfind("--neighbors=", 0) == 0) {
+            neighborCount = std::max(0, std::atoi(arg.c_str() + std::string("--neighbors=").size()));
+        } else if (arg.rfind("--search-neighbors=", 0) == 0) {
+            searchNeighborCount = std::max(0, std::atoi(arg.c_str() + std::string("--search-neighbors=").size()));
+        } else if (arg == "--incremental") {
+            incremental = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << '\n'
+                      << "Usage: superstring [--threads=N] [--neighbors=K] [--search-neighbors=K] [--incremental]\n";
+            return 1;
+        }
+    }
+
     std::ifstream input("input.txt");
     std::vector<std::string> strings;
 
@@ -289,33 +1235,127 @@ int main() {
 
     std::cout << "Input: " << strings.size() << " strings\n";
 
+    // The superstring of the previous run, to be extended with the strings it does not contain yet
+    std::string previous;
+    if (incremental) {
+        std::ifstream previousOutput("output.txt");
+        std::getline(previousOutput, previous);
+    }
+
+    // Everything below works on one-byte symbol codes, lengths are in codepoints
+    strings.push_back(previous);
+    Alphabet alphabet(strings);
+    strings.pop_back();
+    for (auto& s : strings) {
+        s = alphabet.Encode(s);
+    }
+    previous = alphabet.Encode(previous);
+    if (alphabet.IsCompact()) {
+        std::cout << "Alphabet: " << alphabet.GetSize() << " symbols\n";
+    }
+
     std::cout << "Removing redundant substrings...\n";
     strings = RemoveSubstrings(strings);
     std::cout << "After removing substrings: " << strings.size() << " strings\n\n";
 
-    auto overlap = BuildOverlapMatrix(strings);
+    auto writeOutput = [&](const std::string& superstring) {
+        std::ofstream output("output.txt");
+        output << alphabet.Decode(superstring) << '\n';
+        output.close();
+    };
+
+    if (incremental) {
+        std::cout << "Previous superstring length: " << previous.size() << '\n';
+        std::vector<OverlapEdge> edges;
+        std::vector<int> inserted;
+        auto order = IncrementalOrder(strings, previous, edges, inserted);
+        OverlapGraph overlap(strings.size(), std::move(edges));
+        std::cout << "Inserted " << inserted.size() << " new strings: "
+                  << CalculateSuperstringLength(strings, order, overlap) << '\n';
+
+        // Local search starts only around the inserted strings
+        std::vector<int> position(strings.size());
+        for (int p = 0; p < (int)order.size(); p++) {
+            position[order[p]] = p;
+        }
+        std::vector<int> active;
+        for (int t : inserted) {
+            for (int p = std::max(0, position[t] - 1); p <= std::min((int)order.size() - 1, position[t] + 1); p++) {
+                active.push_back(order[p]);
+            }
+        }
+        if (!active.empty()) {
+            LocalSearch(overlap, searchNeighborCount == -1 ? LOCAL_SEARCH_NEIGHBORS : searchNeighborCount)
+                .Optimize(order, active);
+        }
+        std::cout << "After 2-opt and Or-opt: " << CalculateSuperstringLength(strings, order, overlap) << '\n';
+
+        std::string superstring = BuildSuperstring(strings, order, overlap);
+        std::cout << "\nFinal superstring length: " << superstring.size() << '\n';
+        writeOutput(superstring);
+        return 0;
+    }
+
+    // The dense matrix unless asked otherwise or too large; --neighbors=0 forces it
+    if (neighborCount == -1) {
+        neighborCount = strings.size() > DENSE_OVERLAP_MAX_STRINGS ? SPARSE_OVERLAP_NEIGHBORS : 0;
+    }
+    if (neighborCount > 0) {
+        std::cout << "Keeping " << neighborCount << " largest overlaps per string\n";
+    }
+    OverlapGraph overlap(strings, neighborCount, threadCount);
+
+    // Small dense graphs get the full local search, --search-neighbors=0 forces it
+    if (searchNeighborCount == -1) {
+        bool full = neighborCount == 0 && strings.size() <= LOCAL_SEARCH_FULL_MAX_STRINGS;
+        searchNeighborCount = full ? 0 : LOCAL_SEARCH_NEIGHBORS;
+    }
 
     std::cout << "Running greedy algorithm...\n";
     auto order = GreedySuperstring(strings, overlap);
     int length = CalculateSuperstringLength(strings, order, overlap);
     std::cout << "After greedy: " << length << '\n';
 
-    std::cout << "Running 2-opt optimization...\n";
-    TwoOptOptimization(order, strings, overlap);
+    // Missing pairs of the sparse graph would make the bound invalid
+    long long lowerBound = -1;
+    if (neighborCount == 0 && strings.size() >= 2 && strings.size() <= ASSIGNMENT_MAX_STRINGS) {
+        std::cout << "Running cycle cover algorithm...\n";
+        auto successor = MaxOverlapAssignment(overlap);
+        lowerBound = 0;
+        for (int i = 0; i < (int)strings.size(); i++) {
+            lowerBound += (long long)strings[i].size() - overlap.Get(i, successor[i]);
+        }
+        std::cout << "Cycle cover lower bound: " << lowerBound << '\n';
+
+        auto cycleCoverOrder = CycleCoverSuperstring(strings, overlap, successor);
+        int cycleCoverLength = CalculateSuperstringLength(strings, cycleCoverOrder, overlap);
+        std::cout << "After cycle cover: " << cycleCoverLength << '\n';
+        if (cycleCoverLength < length) {
+            order = std::move(cycleCoverOrder);
+            length = cycleCoverLength;
+        }
+    }
+
+    std::cout << "Running 2-opt and Or-opt...\n";
+    LocalSearch search(overlap, searchNeighborCount);
+    search.Optimize(order);
     length = CalculateSuperstringLength(strings, order, overlap);
-    std::cout << "After 2-opt: " << length << '\n';
+    std::cout << "After 2-opt and Or-opt: " << length << '\n';
 
-    std::cout << "Running swap optimization...\n";
-    SwapOptimization(order, strings, overlap);
+    std::cout << "Running window DP (" << DP_WINDOW_SIZE << " strings per window)...\n";
+    WindowOptimization(order, overlap, DP_WINDOW_SIZE, threadCount);
+    search.Optimize(order);
     length = CalculateSuperstringLength(strings, order, overlap);
-    std::cout << "After swap: " << length << '\n';
+    std::cout << "After window DP: " << length << '\n';
 
     std::string superstring = BuildSuperstring(strings, order, overlap);
-    std::cout << "\nFinal superstring length: " << superstring.size() << '\n';
-
-    std::ofstream output("output.txt");
-    output << superstring << '\n';
-    output.close();
+    std::cout << "\nFinal superstring length: " << superstring.size();
+    if (lowerBound > 0) {
+        std::cout << " (lower bound " << lowerBound << ", gap "
+                  << 100.0 * (superstring.size() - lowerBound) / lowerBound << "%)";
+    }
+    std::cout << '\n';
+    writeOutput(superstring);
 
     return 0;
 }
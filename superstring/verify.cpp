@@ -2,14 +2,9 @@
 #include <vector>
 #include <iostream>
 #include <string>
+#include <algorithm>
 
-bool IsSubstring(const std::string& inner, const std::string& outer) {
-    if (inner.size() > outer.size()) {
-        return false;
-    }
-
-    return outer.find(inner) != std::string::npos;
-}
+#include "aho_corasick.h"
 
 int main() {
     std::ifstream input("input.txt");
@@ -27,11 +22,21 @@ int main() {
     output.close();
 
     std::cout << "Input: " << strings.size() << " strings\n";
-    std::cout << "Superstring length: " << superstring.size() << " codepoints\n\n";
-
-    for (const auto& str : strings) {
-        if (!IsSubstring(str, superstring)) {
-            std::cout << "Error - string '" << str << "' is not a substring of the result\n";
+    // UTF-8 continuation bytes do not start a codepoint
+    long long codepoints = std::count_if(superstring.begin(), superstring.end(), [](char c) {
+        return ((unsigned char)c & 0xC0) != 0x80;
+    });
+    std::cout << "Superstring length: " << codepoints << " codepoints\n\n";
+
+    // One pass of the superstring through the automaton counts occurrences of all strings at once
+    AhoCorasick automaton(strings);
+    std::vector<long long> occurrences(automaton.GetNodeCount());
+    automaton.CountVisits(superstring, occurrences);
+    automaton.AccumulateOverFailLinks(occurrences);
+
+    for (int i = 0; i < (int)strings.size(); i++) {
+        if (occurrences[automaton.GetTerminal(i)] == 0) {
+            std::cout << "Error - string '" << strings[i] << "' is not a substring of the result\n";
             return 1;
         }
     }
@@ -0,0 +1,540 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <thread>
+#include <functional>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Precision of distances evaluated by the local search, selected at compile time
+#ifdef TSP_FLOAT_PRECISION
+using Real = float;
+const double EPS = 1e-3;
+#else
+using Real = double;
+const double EPS = 1e-9;
+#endif
+
+const int KD_TREE_LEAF_SIZE = 8;
+
+// City i is points[i]
+struct Point {
+    double x, y;
+};
+
+struct Edge {
+    int u, v;
+    double weight;
+
+    bool operator<(const Edge& other) const {
+        return weight < other.weight;
+    }
+};
+
+inline double EuclideanDistance(const Point& a, const Point& b) {
+    double dx = a.x - b.x;
+    double dy = a.y - b.y;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Structure-of-arrays copy of the coordinates with batch distance kernels (AVX2 gathers when available,
+// SSE2 otherwise, scalar tail)
+class CityCoordinates {
+public:
+    CityCoordinates(const std::vector<Point>& points)
+        : X_(points.size())
+        , Y_(points.size())
+    {
+        for (int i = 0; i < (int)points.size(); i++) {
+            X_[i] = points[i].x;
+            Y_[i] = points[i].y;
+        }
+    }
+
+    Real Distance(int a, int b) const {
+        Real dx = X_[a] - X_[b];
+        Real dy = Y_[a] - Y_[b];
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+    // out[i] = Distance(from, to[i])
+    void Distances(int from, const int* to, int count, Real* out) const {
+        Distances(&from, 0, to, count, out);
+    }
+
+    // out[i] = Distance(from[i], to[i])
+    void Distances(const int* from, const int* to, int count, Real* out) const {
+        Distances(from, 1, to, count, out);
+    }
+
+    double CycleLength(const std::vector<int>& cycle) const {
+        const int BLOCK_SIZE = 256;
+        int n = cycle.size();
+        if (n < 2) {
+            return 0.0;
+        }
+
+        Real buffer[BLOCK_SIZE];
+        double length = Distance(cycle[n - 1], cycle[0]);
+        for (int begin = 0; begin + 1 < n; begin += BLOCK_SIZE) {
+            int count = std::min(BLOCK_SIZE, n - 1 - begin);
+            Distances(cycle.data() + begin, cycle.data() + begin + 1, count, buffer);
+            for (int i = 0; i < count; i++) {
+                length += buffer[i];
+            }
+        }
+
+        return length;
+    }
+
+private:
+    // from[i * fromStride] is paired with to[i]
+    void Distances(const int* from, int fromStride, const int* to, int count, Real* out) const {
+        int i = 0;
+#if defined(__AVX2__) && !defined(TSP_FLOAT_PRECISION)
+        for (; i + 4 <= count; i += 4) {
+            __m128i a = fromStride ? _mm_loadu_si128((const __m128i*)(from + i)) : _mm_set1_epi32(*from);
+            __m128i b = _mm_loadu_si128((const __m128i*)(to + i));
+            __m256d dx = _mm256_sub_pd(_mm256_i32gather_pd(X_.data(), a, 8), _mm256_i32gather_pd(X_.data(), b, 8));
+            __m256d dy = _mm256_sub_pd(_mm256_i32gather_pd(Y_.data(), a, 8), _mm256_i32gather_pd(Y_.data(), b, 8));
+            __m256d sq = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+            _mm256_storeu_pd(out + i, _mm256_sqrt_pd(sq));
+        }
+#elif defined(__AVX2__)
+        for (; i + 8 <= count; i += 8) {
+            __m256i a = fromStride ? _mm256_loadu_si256((const __m256i*)(from + i)) : _mm256_set1_epi32(*from);
+            __m256i b = _mm256_loadu_si256((const __m256i*)(to + i));
+            __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(X_.data(), a, 4), _mm256_i32gather_ps(X_.data(), b, 4));
+            __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(Y_.data(), a, 4), _mm256_i32gather_ps(Y_.data(), b, 4));
+            __m256 sq = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+            _mm256_storeu_ps(out + i, _mm256_sqrt_ps(sq));
+        }
+#elif defined(__SSE2__) && !defined(TSP_FLOAT_PRECISION)
+        // No gathers: coordinates are loaded one by one, the arithmetic is vectorized
+        for (; i + 2 <= count; i += 2) {
+            int a0 = from[i * fromStride];
+            int a1 = from[(i + 1) * fromStride];
+            __m128d dx = _mm_sub_pd(_mm_set_pd(X_[a1], X_[a0]), _mm_set_pd(X_[to[i + 1]], X_[to[i]]));
+            __m128d dy = _mm_sub_pd(_mm_set_pd(Y_[a1], Y_[a0]), _mm_set_pd(Y_[to[i + 1]], Y_[to[i]]));
+            _mm_storeu_pd(out + i, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))));
+        }
+#elif defined(__SSE2__)
+        for (; i + 4 <= count; i += 4) {
+            int a0 = from[i * fromStride];
+            int a1 = from[(i + 1) * fromStride];
+            int a2 = from[(i + 2) * fromStride];
+            int a3 = from[(i + 3) * fromStride];
+            __m128 dx = _mm_sub_ps(_mm_set_ps(X_[a3], X_[a2], X_[a1], X_[a0]),
+                                   _mm_set_ps(X_[to[i + 3]], X_[to[i + 2]], X_[to[i + 1]], X_[to[i]]));
+            __m128 dy = _mm_sub_ps(_mm_set_ps(Y_[a3], Y_[a2], Y_[a1], Y_[a0]),
+                                   _mm_set_ps(Y_[to[i + 3]], Y_[to[i + 2]], Y_[to[i + 1]], Y_[to[i]]));
+            _mm_storeu_ps(out + i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy))));
+        }
+#endif
+        for (; i < count; i++) {
+            out[i] = Distance(from[i * fromStride], to[i]);
+        }
+    }
+
+    std::vector<Real> X_;
+    std::vector<Real> Y_;
+};
+
+class DSU {
+public:
+    DSU(int set_count)
+        : Parent_(set_count)
+        , Rank_(set_count)
+    {
+        for (int i = 0; i < set_count; i++) {
+            Parent_[i] = i;
+        }
+    }
+
+    int GetParent(int v) {
+        if (Parent_[v] != v) {
+            Parent_[v] = GetParent(Parent_[v]);
+        }
+
+        return Parent_[v];
+    }
+
+    bool Unite(int v, int u) {
+        v = GetParent(v);
+        u = GetParent(u);
+        if (v == u) {
+            return false;
+        }
+
+        if (Rank_[v] < Rank_[u]) {
+            std::swap(v, u);
+        }
+
+        Parent_[u] = v;
+        if (Rank_[v] == Rank_[u]) {
+            Rank_[v]++;
+        }
+
+        return true;
+    }
+
+private:
+    std::vector<int> Parent_;
+    std::vector<int> Rank_;
+};
+
+class KdTree {
+public:
+    KdTree(const std::vector<Point>& points)
+        : Points_(points)
+        , Order_(points.size())
+        , LeafOf_(points.size())
+    {
+        std::iota(Order_.begin(), Order_.end(), 0);
+        if (!points.empty()) {
+            Build(0, points.size());
+        }
+    }
+
+    // Points in leaf order: neighbouring indices are close in the plane
+    const std::vector<int>& GetOrder() const {
+        return Order_;
+    }
+
+    // Marks every node whose points all share the same color, so that searches can skip it entirely
+    void UpdateColors(const std::vector<int>& colors) {
+        NodeColor_.assign(Nodes_.size(), -1);
+        for (int node = (int)Nodes_.size() - 1; node >= 0; node--) {
+            NodeColor_[node] = CalculateColor(node, colors);
+        }
+    }
+
+    // Same as UpdateColors after colors[v] alone has changed, O(leaf size + depth)
+    void UpdateColor(int v, const std::vector<int>& colors) {
+        for (int node = LeafOf_[v]; node != -1; node = Nodes_[node].parent) {
+            int color = CalculateColor(node, colors);
+            if (color == NodeColor_[node] && node != LeafOf_[v]) {
+                break;
+            }
+            NodeColor_[node] = color;
+        }
+    }
+
+    // Nearest point of a color other than colors[v] strictly closer than sqrt(bestSq), -1 if there is none
+    int NearestOfOtherColor(int v, const std::vector<int>& colors, double& bestSq) const {
+        int best = -1;
+        NearestOfOtherColor(0, v, colors, bestSq, best);
+        return best;
+    }
+
+    // Up to k nearest points to v (excluding v itself), closest first
+    std::vector<int> NearestNeighbors(int v, int k) const {
+        std::vector<std::pair<double, int>> heap;
+        heap.reserve(k);
+        if (k > 0 && !Nodes_.empty()) {
+            // Start from v's own leaf and climb up, so that the bound is tight from the very beginning
+            NearestNeighbors(LeafOf_[v], v, k, heap);
+            for (int node = LeafOf_[v]; Nodes_[node].parent != -1; node = Nodes_[node].parent) {
+                const auto& parent = Nodes_[Nodes_[node].parent];
+                NearestNeighbors(parent.left == node ? parent.right : parent.left, v, k, heap);
+            }
+        }
+        std::sort_heap(heap.begin(), heap.end());
+
+        std::vector<int> neighbors;
+        for (const auto& [distSq, u] : heap) {
+            neighbors.push_back(u);
+        }
+
+        return neighbors;
+    }
+
+private:
+    struct Node {
+        double minX, maxX, minY, maxY;
+        int begin, end;
+        int left, right;
+        int parent;
+    };
+
+    int CalculateColor(int node, const std::vector<int>& colors) const {
+        const auto& current = Nodes_[node];
+        if (current.left != -1) {
+            return NodeColor_[current.left] == NodeColor_[current.right] ? NodeColor_[current.left] : -1;
+        }
+
+        int color = colors[Order_[current.begin]];
+        for (int i = current.begin + 1; i < current.end; i++) {
+            if (colors[Order_[i]] != color) {
+                return -1;
+            }
+        }
+
+        return color;
+    }
+
+    int Build(int begin, int end) {
+        int node = Nodes_.size();
+        Nodes_.push_back({
+            std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(),
+            std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(),
+            begin, end, -1, -1, -1
+        });
+
+        Node bounds = Nodes_[node];
+        for (int i = begin; i < end; i++) {
+            const auto& point = Points_[Order_[i]];
+            bounds.minX = std::min(bounds.minX, point.x);
+            bounds.maxX = std::max(bounds.maxX, point.x);
+            bounds.minY = std::min(bounds.minY, point.y);
+            bounds.maxY = std::max(bounds.maxY, point.y);
+        }
+
+        if (end - begin > KD_TREE_LEAF_SIZE) {
+            bool splitByX = bounds.maxX - bounds.minX >= bounds.maxY - bounds.minY;
+            int middle = begin + (end - begin) / 2;
+            std::nth_element(Order_.begin() + begin, Order_.begin() + middle, Order_.begin() + end, [&](int a, int b) {
+                return splitByX ? Points_[a].x < Points_[b].x : Points_[a].y < Points_[b].y;
+            });
+
+            bounds.left = Build(begin, middle);
+            bounds.right = Build(middle, end);
+            Nodes_[bounds.left].parent = node;
+            Nodes_[bounds.right].parent = node;
+        } else {
+            for (int i = begin; i < end; i++) {
+                LeafOf_[Order_[i]] = node;
+            }
+        }
+
+        Nodes_[node] = bounds;
+        return node;
+    }
+
+    double BoxDistanceSq(int node, const Point& point) const {
+        const auto& current = Nodes_[node];
+        double dx = std::max({0.0, current.minX - point.x, point.x - current.maxX});
+        double dy = std::max({0.0, current.minY - point.y, point.y - current.maxY});
+        return dx * dx + dy * dy;
+    }
+
+    void NearestOfOtherColor(int node, int v, const std::vector<int>& colors, double& bestSq, int& best) const {
+        if (NodeColor_[node] == colors[v] || BoxDistanceSq(node, Points_[v]) >= bestSq) {
+            return;
+        }
+
+        const auto& current = Nodes_[node];
+        if (current.left == -1) {
+            for (int i = current.begin; i < current.end; i++) {
+                int u = Order_[i];
+                if (colors[u] == colors[v]) {
+                    continue;
+                }
+
+                double dx = Points_[u].x - Points_[v].x;
+                double dy = Points_[u].y - Points_[v].y;
+                double distSq = dx * dx + dy * dy;
+                if (distSq < bestSq) {
+                    bestSq = distSq;
+                    best = u;
+                }
+            }
+            return;
+        }
+
+        int nearChild = current.left;
+        int farChild = current.right;
+        if (BoxDistanceSq(farChild, Points_[v]) < BoxDistanceSq(nearChild, Points_[v])) {
+            std::swap(nearChild, farChild);
+        }
+
+        NearestOfOtherColor(nearChild, v, colors, bestSq, best);
+        NearestOfOtherColor(farChild, v, colors, bestSq, best);
+    }
+
+    void NearestNeighbors(int node, int v, int k, std::vector<std::pair<double, int>>& heap) const {
+        if ((int)heap.size() == k && BoxDistanceSq(node, Points_[v]) >= heap.front().first) {
+            return;
+        }
+
+        const auto& current = Nodes_[node];
+        if (current.left == -1) {
+            for (int i = current.begin; i < current.end; i++) {
+                int u = Order_[i];
+                if (u == v) {
+                    continue;
+                }
+
+                double dx = Points_[u].x - Points_[v].x;
+                double dy = Points_[u].y - Points_[v].y;
+                double distSq = dx * dx + dy * dy;
+                if ((int)heap.size() < k) {
+                    heap.push_back({distSq, u});
+                    std::push_heap(heap.begin(), heap.end());
+                } else if (distSq < heap.front().first) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = {distSq, u};
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+            return;
+        }
+
+        int nearChild = current.left;
+        int farChild = current.right;
+        if (BoxDistanceSq(farChild, Points_[v]) < BoxDistanceSq(nearChild, Points_[v])) {
+            std::swap(nearChild, farChild);
+        }
+
+        NearestNeighbors(nearChild, v, k, heap);
+        NearestNeighbors(farChild, v, k, heap);
+    }
+
+    const std::vector<Point>& Points_;
+    std::vector<int> Order_;
+    std::vector<int> LeafOf_;
+    std::vector<Node> Nodes_;
+    std::vector<int> NodeColor_;
+};
+
+struct BoruvkaCandidate {
+    int component;
+    int u, v;
+    double distSq;
+};
+
+// Strict order on candidate edges, ties are broken by endpoints so that Boruvka never closes a cycle
+inline bool IsBetterCandidate(const BoruvkaCandidate& a, const BoruvkaCandidate& b) {
+    if (a.distSq != b.distSq) {
+        return a.distSq < b.distSq;
+    }
+
+    return std::minmax(a.u, a.v) < std::minmax(b.u, b.v);
+}
+
+// Shortest outgoing edge for every run of same-component points in order[begin, end)
+inline void FindBoruvkaCandidates(const KdTree& tree, const std::vector<int>& component,
+                                  int begin, int end, std::vector<BoruvkaCandidate>& candidates) {
+    const auto& order = tree.GetOrder();
+
+    BoruvkaCandidate current = {-1, -1, -1, 0.0};
+    for (int i = begin; i < end; i++) {
+        int v = order[i];
+        if (component[v] != current.component) {
+            if (current.u != -1) {
+                candidates.push_back(current);
+            }
+            current = {component[v], -1, -1, std::numeric_limits<double>::max()};
+        }
+
+        // Bound is shared by the whole run, so most of the queries are pruned right at the root
+        double bestSq = current.distSq;
+        int u = tree.NearestOfOtherColor(v, component, bestSq);
+        if (u != -1) {
+            BoruvkaCandidate candidate = {component[v], v, u, bestSq};
+            if (current.u == -1 || IsBetterCandidate(candidate, current)) {
+                current = candidate;
+            }
+        }
+    }
+
+    if (current.u != -1) {
+        candidates.push_back(current);
+    }
+}
+
+// Euclidean MST via Boruvka rounds over a k-d tree: O(n) memory instead of the complete graph
+inline std::vector<Edge> BuildMST(const std::vector<Point>& points, int threadCount) {
+    int n = points.size();
+    std::vector<Edge> mst;
+    if (n < 2) {
+        return mst;
+    }
+
+    threadCount = std::max(1, std::min(threadCount, n / KD_TREE_LEAF_SIZE));
+
+    KdTree tree(points);
+    DSU dsu(n);
+    std::vector<int> component(n);
+    std::iota(component.begin(), component.end(), 0);
+
+    std::vector<BoruvkaCandidate> best(n);
+    std::vector<std::vector<BoruvkaCandidate>> threadCandidates(threadCount);
+    while ((int)mst.size() + 1 < n) {
+        tree.UpdateColors(component);
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threadCount; t++) {
+            threadCandidates[t].clear();
+            int begin = (long long)n * t / threadCount;
+            int end = (long long)n * (t + 1) / threadCount;
+            if (t + 1 == threadCount) {
+                FindBoruvkaCandidates(tree, component, begin, end, threadCandidates[t]);
+            } else {
+                workers.emplace_back(FindBoruvkaCandidates, std::cref(tree), std::cref(component),
+                                     begin, end, std::ref(threadCandidates[t]));
+            }
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        for (int v = 0; v < n; v++) {
+            best[v].u = -1;
+        }
+        for (const auto& candidates : threadCandidates) {
+            for (const auto& candidate : candidates) {
+                auto& current = best[candidate.component];
+                if (current.u == -1 || IsBetterCandidate(candidate, current)) {
+                    current = candidate;
+                }
+            }
+        }
+
+        for (int v = 0; v < n; v++) {
+            if (best[v].u != -1 && dsu.Unite(best[v].u, best[v].v)) {
+                mst.push_back({best[v].u, best[v].v, std::sqrt(best[v].distSq)});
+            }
+        }
+
+        for (int v = 0; v < n; v++) {
+            component[v] = dsu.GetParent(v);
+        }
+    }
+
+    return mst;
+}
+
+inline std::vector<std::vector<int>> BuildNeighborLists(const std::vector<Point>& points, int k, int threadCount) {
+    KdTree tree(points);
+    std::vector<std::vector<int>> neighbors(points.size());
+
+    // Tree order keeps consecutive queries in the same part of the tree
+    const auto& order = tree.GetOrder();
+    auto worker = [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            neighbors[order[i]] = tree.NearestNeighbors(order[i], k);
+        }
+    };
+
+    int n = points.size();
+    threadCount = std::max(1, std::min(threadCount, n / 1024));
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threadCount; t++) {
+        workers.emplace_back(worker, (long long)n * t / threadCount, (long long)n * (t + 1) / threadCount);
+    }
+    worker(0, n / threadCount);
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    return neighbors;
+}
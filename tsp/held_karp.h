@@ -0,0 +1,374 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "geometry.h"
+
+const int HELD_KARP_GRAPH_NEIGHBORS = 10;
+const int HELD_KARP_MAX_ITERATIONS = 100;
+const int HELD_KARP_PATIENCE = 3;
+const double HELD_KARP_MIN_STEP = 1e-3;
+
+// Held-Karp lower bound: max over penalties pi of (min 1-tree length with edge weights d(u, v) + pi[u] + pi[v]) - 2 * sum(pi),
+// maximized by subgradient ascent. During the ascent 1-trees are built on a sparse candidate graph (k nearest neighbors
+// plus the Euclidean MST), like in LKH. The reported bound is the 1-tree on the complete graph for the best penalties,
+// so it is a valid lower bound for any penalties the ascent ends with
+class HeldKarpBound {
+public:
+    HeldKarpBound(const std::vector<Point>& points, int threadCount)
+        : Penalties_(points.size())
+        , Degrees_(points.size())
+    {
+        int n = points.size();
+        for (const auto& point : points) {
+            X_.push_back(point.x);
+            Y_.push_back(point.y);
+        }
+
+        auto neighbors = BuildNeighborLists(points, HELD_KARP_GRAPH_NEIGHBORS, threadCount);
+        auto mst = BuildMST(points, threadCount);
+
+        std::vector<int> mstDegree(n);
+        for (auto edge : mst) {
+            mstDegree[edge.u]++;
+            mstDegree[edge.v]++;
+            Edges_.push_back({std::min(edge.u, edge.v), std::max(edge.u, edge.v), edge.weight});
+        }
+        for (int v = 0; v < n; v++) {
+            for (int u : neighbors[v]) {
+                Edges_.push_back({std::min(u, v), std::max(u, v), EuclideanDistance(points[u], points[v])});
+            }
+        }
+
+        auto byEnds = [](const Edge& a, const Edge& b) {
+            return std::make_pair(a.u, a.v) < std::make_pair(b.u, b.v);
+        };
+        auto sameEnds = [](const Edge& a, const Edge& b) {
+            return a.u == b.u && a.v == b.v;
+        };
+        std::sort(Edges_.begin(), Edges_.end(), byEnds);
+        Edges_.erase(std::unique(Edges_.begin(), Edges_.end(), sameEnds), Edges_.end());
+
+        // A leaf of the Euclidean MST: the graph stays connected without it
+        Special_ = std::find(mstDegree.begin(), mstDegree.end(), 1) - mstDegree.begin();
+    }
+
+    // Runs the ascent, upperBound is the length of any tour and drives the step size
+    double Compute(double upperBound) {
+        int n = Penalties_.size();
+        if (n < 3 || Special_ == n) {
+            return 0.0;
+        }
+
+        std::fill(Penalties_.begin(), Penalties_.end(), 0.0);
+        std::vector<double> bestPenalties = Penalties_;
+        double best = std::numeric_limits<double>::lowest();
+        double step = 2.0;
+        int stall = 0;
+
+        for (int iteration = 0; iteration < HELD_KARP_MAX_ITERATIONS && step > HELD_KARP_MIN_STEP; iteration++) {
+            double bound = BuildOneTree();
+            if (bound > best) {
+                best = bound;
+                bestPenalties = Penalties_;
+                stall = 0;
+            } else if (++stall == HELD_KARP_PATIENCE) {
+                step /= 2;
+                stall = 0;
+            }
+
+            long long norm = 0;
+            for (int v = 0; v < n; v++) {
+                norm += (long long)(Degrees_[v] - 2) * (Degrees_[v] - 2);
+            }
+
+            // Every degree is 2: the 1-tree is an optimal tour
+            if (norm == 0) {
+                break;
+            }
+
+            double t = step * std::max(upperBound - bound, 0.0) / norm;
+            for (int v = 0; v < n; v++) {
+                Penalties_[v] += t * (Degrees_[v] - 2);
+            }
+        }
+
+        Penalties_ = bestPenalties;
+        BuildOneTree();
+        Bound_ = BuildCompleteOneTree();
+        return Bound_;
+    }
+
+    double GetBound() const {
+        return Bound_;
+    }
+
+    // For every city, k candidate edges with the smallest alpha-nearness: the increase of the 1-tree length
+    // when the edge is forced into it. Candidates are taken from the sparse graph and returned sorted by
+    // distance, so they can replace plain nearest neighbor lists
+    std::vector<std::vector<int>> AlphaNearestNeighbors(int k) const {
+        int n = Penalties_.size();
+        std::vector<double> alpha = CalculateAlphaNearness();
+
+        std::vector<std::vector<int>> incident(n);
+        for (int e = 0; e < (int)Edges_.size(); e++) {
+            incident[Edges_[e].u].push_back(e);
+            incident[Edges_[e].v].push_back(e);
+        }
+
+        std::vector<std::vector<int>> neighbors(n);
+        for (int v = 0; v < n; v++) {
+            auto& edges = incident[v];
+            std::sort(edges.begin(), edges.end(), [&](int a, int b) {
+                return std::make_pair(alpha[a], Edges_[a].weight) < std::make_pair(alpha[b], Edges_[b].weight);
+            });
+            edges.resize(std::min<int>(edges.size(), k));
+            std::sort(edges.begin(), edges.end(), [&](int a, int b) {
+                return Edges_[a].weight < Edges_[b].weight;
+            });
+
+            for (int e : edges) {
+                neighbors[v].push_back(Edges_[e].u == v ? Edges_[e].v : Edges_[e].u);
+            }
+        }
+
+        return neighbors;
+    }
+
+private:
+    double Weight(int e) const {
+        return Edges_[e].weight + Penalties_[Edges_[e].u] + Penalties_[Edges_[e].v];
+    }
+
+    bool IsSpecial(int e) const {
+        return Edges_[e].u == Special_ || Edges_[e].v == Special_;
+    }
+
+    // Edges of the graph without the special city in Kruskal order. Penalties change a little between
+    // iterations, so the previous order is re-sorted: almost sorted input is much cheaper to sort
+    const std::vector<std::pair<double, int>>& SortedEdges() {
+        if (Order_.empty()) {
+            for (int e = 0; e < (int)Edges_.size(); e++) {
+                if (!IsSpecial(e)) {
+                    Order_.push_back({0.0, e});
+                }
+            }
+        }
+
+        for (auto& [weight, e] : Order_) {
+            weight = Weight(e);
+        }
+        std::sort(Order_.begin(), Order_.end());
+
+        return Order_;
+    }
+
+    // Two cheapest edges of the special city
+    std::pair<int, int> SpecialEdges() const {
+        int first = -1;
+        int second = -1;
+        for (int e = 0; e < (int)Edges_.size(); e++) {
+            if (!IsSpecial(e)) {
+                continue;
+            }
+
+            if (first == -1 || Weight(e) < Weight(first)) {
+                second = first;
+                first = e;
+            } else if (second == -1 || Weight(e) < Weight(second)) {
+                second = e;
+            }
+        }
+
+        return {first, second};
+    }
+
+    // Minimum 1-tree for the current penalties: MST without the special city plus its two cheapest edges.
+    // Fills Degrees_ and returns the penalized length minus 2 * sum(pi)
+    double BuildOneTree() {
+        int n = Penalties_.size();
+        std::fill(Degrees_.begin(), Degrees_.end(), 0);
+
+        DSU dsu(n);
+        double length = 0.0;
+        for (const auto& [weight, e] : SortedEdges()) {
+            if (dsu.Unite(Edges_[e].u, Edges_[e].v)) {
+                length += weight;
+                Degrees_[Edges_[e].u]++;
+                Degrees_[Edges_[e].v]++;
+            }
+        }
+
+        auto [first, second] = SpecialEdges();
+        for (int e : {first, second}) {
+            length += Weight(e);
+            Degrees_[Edges_[e].u]++;
+            Degrees_[Edges_[e].v]++;
+        }
+
+        for (int v = 0; v < n; v++) {
+            length -= 2 * Penalties_[v];
+        }
+
+        return length;
+    }
+
+    // Minimum 1-tree on the complete graph for the current penalties: O(n^2) Prim without the special city plus
+    // its two cheapest edges among all cities. Cities outside the tree are kept packed at the front of the arrays,
+    // so the key update is a plain loop over them. Degrees_ are left from the sparse tree
+    double BuildCompleteOneTree() const {
+        int n = Penalties_.size();
+        const double infinity = std::numeric_limits<double>::max();
+
+        std::vector<int> city;
+        std::vector<double> x, y, penalty;
+        for (int v = 0; v < n; v++) {
+            if (v != Special_) {
+                city.push_back(v);
+                x.push_back(X_[v]);
+                y.push_back(Y_[v]);
+                penalty.push_back(Penalties_[v]);
+            }
+        }
+        std::vector<double> key(city.size(), infinity);
+
+        auto removeAt = [&](int i) {
+            int last = (int)city.size() - 1;
+            city[i] = city[last];
+            x[i] = x[last];
+            y[i] = y[last];
+            penalty[i] = penalty[last];
+            key[i] = key[last];
+            city.pop_back();
+            x.pop_back();
+            y.pop_back();
+            penalty.pop_back();
+            key.pop_back();
+        };
+
+        double length = 0.0;
+        int current = city.back();
+        removeAt(city.size() - 1);
+        while (!city.empty()) {
+            int count = city.size();
+            double currentX = X_[current];
+            double currentY = Y_[current];
+            double currentPenalty = Penalties_[current];
+            for (int i = 0; i < count; i++) {
+                double dx = x[i] - currentX;
+                double dy = y[i] - currentY;
+                key[i] = std::min(key[i], std::sqrt(dx * dx + dy * dy) + currentPenalty + penalty[i]);
+            }
+
+            int next = std::min_element(key.begin(), key.end()) - key.begin();
+            length += key[next];
+            current = city[next];
+            removeAt(next);
+        }
+
+        double first = infinity;
+        double second = infinity;
+        for (int v = 0; v < n; v++) {
+            if (v == Special_) {
+                continue;
+            }
+
+            double dx = X_[v] - X_[Special_];
+            double dy = Y_[v] - Y_[Special_];
+            double weight = std::sqrt(dx * dx + dy * dy) + Penalties_[Special_] + Penalties_[v];
+            if (weight < first) {
+                second = first;
+                first = weight;
+            } else if (weight < second) {
+                second = weight;
+            }
+        }
+        length += first + second;
+
+        for (int v = 0; v < n; v++) {
+            length -= 2 * Penalties_[v];
+        }
+
+        return length;
+    }
+
+    // alpha(u, v) = w(u, v) - beta(u, v), where beta is the heaviest edge on the tree path between u and v.
+    // beta of every graph edge is found during Kruskal: each pending edge waits in the lists of both endpoint
+    // components, and the smaller list is moved into the larger one on every union
+    std::vector<double> CalculateAlphaNearness() const {
+        int n = Penalties_.size();
+        int m = Edges_.size();
+        std::vector<double> alpha(m, 0.0);
+        if (n < 3 || Special_ == n) {
+            return alpha;
+        }
+
+        std::vector<std::vector<int>> pending(n);
+        std::vector<bool> resolved(m, false);
+        for (int e = 0; e < m; e++) {
+            if (!IsSpecial(e)) {
+                pending[Edges_[e].u].push_back(e);
+                pending[Edges_[e].v].push_back(e);
+            }
+        }
+
+        DSU dsu(n);
+        for (const auto& [weight, e] : Order_) {
+            int a = dsu.GetParent(Edges_[e].u);
+            int b = dsu.GetParent(Edges_[e].v);
+            if (a == b) {
+                continue;
+            }
+
+            if (pending[a].size() > pending[b].size()) {
+                std::swap(a, b);
+            }
+
+            std::vector<int> moved;
+            for (int q : pending[a]) {
+                if (resolved[q]) {
+                    continue;
+                }
+
+                int rootU = dsu.GetParent(Edges_[q].u);
+                int rootV = dsu.GetParent(Edges_[q].v);
+                if ((rootU == a && rootV == b) || (rootU == b && rootV == a)) {
+                    resolved[q] = true;
+                    alpha[q] = Weight(q) - weight;
+                } else {
+                    moved.push_back(q);
+                }
+            }
+
+            std::vector<int> merged = std::move(pending[b]);
+            merged.insert(merged.end(), moved.begin(), moved.end());
+            pending[a].clear();
+            pending[b].clear();
+
+            dsu.Unite(a, b);
+            pending[dsu.GetParent(a)] = std::move(merged);
+        }
+
+        // Forcing an edge of the special city replaces the more expensive of its two tree edges
+        double secondWeight = Weight(SpecialEdges().second);
+        for (int e = 0; e < m; e++) {
+            if (IsSpecial(e)) {
+                alpha[e] = std::max(0.0, Weight(e) - secondWeight);
+            }
+        }
+
+        return alpha;
+    }
+
+    std::vector<double> X_;
+    std::vector<double> Y_;
+    std::vector<Edge> Edges_;
+    std::vector<std::pair<double, int>> Order_;
+    std::vector<double> Penalties_;
+    std::vector<int> Degrees_;
+    int Special_ = 0;
+    double Bound_ = 0.0;
+};
@@ -1,99 +1,109 @@
 #include <fstream>
 #include <vector>
 #include <iostream>
-#include <unordered_set>
+#include <unordered_map>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <thread>
+#include <deque>
+#include <array>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <cmath>
+#include <chrono>
+#include <random>
 
-const int PEEPHOLE_OPT_ITERATIONS = 10;
-const double EPS = 1e-9;
-
-struct Point {
-    int id;
-    double x, y;
-};
-
-struct Edge {
-    int u, v;
-    double weight;
-
-    bool operator<(const Edge& other) const {
-        return weight < other.weight;
-    }
-};
-
-double EuclideanDistance(const Point& a, const Point& b) {
-    double dx = a.x - b.x;
-    double dy = a.y - b.y;
-    return std::sqrt(dx * dx + dy * dy);
-}
+#include "geometry.h"
+#include "held_karp.h"
 
+const int NEIGHBOR_LIST_SIZE = 10;
+const int ALPHA_NEIGHBOR_LIST_SIZE = 6;
+const int INSERTION_NEIGHBOR_COUNT = 10;
+const int POPULATION_SIZE = 8;
+const int DEADLINE_CHECK_INTERVAL = 256;
+const int PERTURBATION_WINDOW = 50;
+const int PERTURBATION_CITIES_PER_KICK = 500;
+const int OR_OPT_MAX_SEGMENT = 3;
+const int LK_MAX_DEPTH = 50;
+const int LK_BREADTH = 5;
+const int MATCHING_NEIGHBOR_LIST_SIZE = 10;
+const double MATCHING_WEIGHT_SCALE = 1000.0;
+const int MATCHING_CLUSTER_SIZE = 1000;
+const int PARALLEL_ROUNDS = 4;
+const int PARALLEL_SEGMENTS_PER_THREAD = 2;
+const int PARALLEL_MIN_SEGMENT_SIZE = 1000;
 
-class DSU {
+// Fixed set of worker threads executing submitted tasks in FIFO order
+class ThreadPool {
 public:
-    DSU(int set_count)
-        : Parent_(set_count)
-        , Rank_(set_count)
-    {
-        for (int i = 0; i < set_count; i++) {
-            Parent_[i] = i;
-        }
-    }
-
-    int GetParent(int v) {
-        if (Parent_[v] != v) {
-            Parent_[v] = GetParent(Parent_[v]);
+    ThreadPool(int threadCount) {
+        for (int i = 0; i < threadCount; i++) {
+            Workers_.emplace_back([this] { Work(); });
         }
-
-        return Parent_[v];
     }
 
-    bool Unite(int v, int u) {
-        v = GetParent(v);
-        u = GetParent(u);
-        if (v == u) {
-            return false;
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(Mutex_);
+            Stopping_ = true;
         }
-
-        if (Rank_[v] < Rank_[u]) {
-            std::swap(v, u);
+        TaskAdded_.notify_all();
+        for (auto& worker : Workers_) {
+            worker.join();
         }
+    }
 
-        Parent_[u] = v;
-        if (Rank_[v] == Rank_[u]) {
-            Rank_[v]++;
+    void Submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(Mutex_);
+            Tasks_.push_back(std::move(task));
+            Unfinished_++;
         }
+        TaskAdded_.notify_one();
+    }
 
-        return true;
+    // Blocks until every submitted task has finished
+    void Wait() {
+        std::unique_lock<std::mutex> lock(Mutex_);
+        AllFinished_.wait(lock, [this] { return Unfinished_ == 0; });
     }
 
 private:
-    std::vector<int> Parent_;
-    std::vector<int> Rank_;
-};
-
-std::vector<Edge> BuildMST(const std::vector<Point>& points) {
-    std::vector<Edge> allEdges;
-    for (int v = 0; v < (int)points.size(); v++) {
-        for (int u = v + 1; u < (int)points.size(); u++) {
-            allEdges.push_back({v, u, EuclideanDistance(points[v], points[u]) });
-        }
-    }
+    void Work() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(Mutex_);
+                TaskAdded_.wait(lock, [this] { return Stopping_ || !Tasks_.empty(); });
+                if (Tasks_.empty()) {
+                    return;
+                }
 
-    std::sort(allEdges.begin(), allEdges.end());
+                task = std::move(Tasks_.front());
+                Tasks_.pop_front();
+            }
 
-    DSU dsu(points.size());
-    std::vector<Edge> mst;
+            task();
 
-    for (const auto& edge : allEdges) {
-        if (dsu.Unite(edge.u, edge.v)) {
-            mst.push_back(edge);
-            if (mst.size() + 1 == points.size()) {
-                break;
+            std::lock_guard<std::mutex> lock(Mutex_);
+            if (--Unfinished_ == 0) {
+                AllFinished_.notify_all();
             }
         }
     }
 
-    return mst;
-}
+    std::vector<std::thread> Workers_;
+    std::deque<std::function<void()>> Tasks_;
+    std::mutex Mutex_;
+    std::condition_variable TaskAdded_;
+    std::condition_variable AllFinished_;
+    int Unfinished_ = 0;
+    bool Stopping_ = false;
+};
 
 std::vector<int> FindOddDegreeVertices(const std::vector<Edge>& mst, int verticesCount) {
     std::vector<int> degree(verticesCount);
@@ -126,46 +136,65 @@ std::vector<Edge> GreedyMinimumMatching(const std::vector<int>& oddVertices, con
 
     std::sort(allEdges.begin(), allEdges.end());
 
-    std::unordered_set<int> usedVertices;
+    std::vector<bool> usedVertices(points.size());
     std::vector<Edge> matching;
     for (const auto& edge : allEdges) {
-        if (usedVertices.find(edge.u) == usedVertices.end() && usedVertices.find(edge.v) == usedVertices.end()) {
+        if (!usedVertices[edge.u] && !usedVertices[edge.v]) {
             matching.push_back(edge);
-            usedVertices.insert(edge.u);
-            usedVertices.insert(edge.v);
+            usedVertices[edge.u] = true;
+            usedVertices[edge.v] = true;
         }
     }
 
     return matching;
 }
 
-std::vector<std::vector<int>> BuildAdjacencyList(const std::vector<Edge>& edges, int n) {
-    std::vector<std::vector<int>> graph(n);
+// Multigraph in compressed sparse row form: ids of the edges incident to v are Incident[Offset[v] .. Offset[v + 1])
+struct CsrGraph {
+    std::vector<int> Offset;
+    std::vector<int> Incident;
+};
+
+CsrGraph BuildCsrGraph(const std::vector<Edge>& edges, int n) {
+    CsrGraph graph;
+    graph.Offset.assign(n + 1, 0);
     for (const auto& edge : edges) {
-        graph[edge.u].push_back(edge.v);
-        graph[edge.v].push_back(edge.u);
+        graph.Offset[edge.u + 1]++;
+        graph.Offset[edge.v + 1]++;
+    }
+    std::partial_sum(graph.Offset.begin(), graph.Offset.end(), graph.Offset.begin());
+
+    std::vector<int> filled(graph.Offset.begin(), graph.Offset.end() - 1);
+    graph.Incident.resize(2 * edges.size());
+    for (int e = 0; e < (int)edges.size(); e++) {
+        graph.Incident[filled[edges[e].u]++] = e;
+        graph.Incident[filled[edges[e].v]++] = e;
     }
 
     return graph;
 }
 
-std::vector<int> FindEulerianCycle(std::vector<std::vector<int>> graph, int start) {
+// Hierholzer's algorithm in O(V + E): every vertex keeps a cursor into its incident edges,
+// edges already walked through the other endpoint are skipped by the used bitmap
+std::vector<int> FindEulerianCycle(const std::vector<Edge>& edges, const CsrGraph& graph, int start) {
+    std::vector<int> cursor(graph.Offset.begin(), graph.Offset.end() - 1);
+    std::vector<bool> used(edges.size(), false);
     std::vector<int> cycle;
     std::vector<int> stack;
+    cycle.reserve(edges.size() + 1);
+    stack.reserve(edges.size() + 1);
     stack.push_back(start);
 
     while (!stack.empty()) {
-        int v = stack.back();        
-        if (!graph[v].empty()) {
-            int u = graph[v].back();
-            graph[v].pop_back();
-
-            auto it = std::find(graph[u].begin(), graph[u].end(), v);
-            if (it != graph[u].end()) {
-                graph[u].erase(it);
-            }
+        int v = stack.back();
+        while (cursor[v] < graph.Offset[v + 1] && used[graph.Incident[cursor[v]]]) {
+            cursor[v]++;
+        }
 
-            stack.push_back(u);
+        if (cursor[v] < graph.Offset[v + 1]) {
+            int e = graph.Incident[cursor[v]++];
+            used[e] = true;
+            stack.push_back(edges[e].u == v ? edges[e].v : edges[e].u);
         } else {
             cycle.push_back(v);
             stack.pop_back();
@@ -176,97 +205,2286 @@ std::vector<int> FindEulerianCycle(std::vector<std::vector<int>> graph, int star
     return cycle;
 }
 
-std::vector<int> EulerianToHamiltonian(const std::vector<int>& eulerCycle) {
+// Keeps the first occurrence of every vertex
+std::vector<int> EulerianToHamiltonian(const std::vector<int>& eulerCycle, int n) {
     std::vector<int> hamCycle;
-    std::unordered_set<int> visited;
+    std::vector<bool> visited(n, false);
     for (int v : eulerCycle) {
-        if (visited.find(v) == visited.end()) {
+        if (!visited[v]) {
             hamCycle.push_back(v);
-            visited.insert(v);
+            visited[v] = true;
         }
     }
 
     return hamCycle;
 }
 
-double CalculateCycleLength(const std::vector<int>& cycle, const std::vector<Point>& points) {
-    double length = 0.0;
-    for (int v = 0; v < (int)cycle.size(); v++) {
-        int u = (v + 1) % cycle.size();
-        length += EuclideanDistance(points[cycle[v]], points[cycle[u]]);
+// Smart shortcutting: of all occurrences of a vertex in the walk, the one whose removal saves the least is kept,
+// the rest are shortcut. The walk is a linked list of occurrences, so savings account for earlier shortcuts
+std::vector<int> SmartEulerianToHamiltonian(const std::vector<int>& eulerCycle, const std::vector<Point>& points) {
+    int n = points.size();
+    int m = eulerCycle.size() - 1;  // The walk is closed: the last vertex repeats the first one
+    if (m <= 0) {
+        return eulerCycle;
+    }
+
+    std::vector<int> next(m);
+    std::vector<int> prev(m);
+    std::vector<int> offset(n + 1, 0);
+    for (int i = 0; i < m; i++) {
+        next[i] = (i + 1) % m;
+        prev[i] = (i + m - 1) % m;
+        offset[eulerCycle[i] + 1]++;
+    }
+    std::partial_sum(offset.begin(), offset.end(), offset.begin());
+
+    std::vector<int> occurrences(m);
+    std::vector<int> filled(offset.begin(), offset.end() - 1);
+    for (int i = 0; i < m; i++) {
+        occurrences[filled[eulerCycle[i]]++] = i;
+    }
+
+    auto distance = [&](int i, int j) {
+        return EuclideanDistance(points[eulerCycle[i]], points[eulerCycle[j]]);
+    };
+
+    int kept = 0;
+    for (int v = 0; v < n; v++) {
+        int keep = -1;
+        double keepSaving = std::numeric_limits<double>::max();
+        for (int k = offset[v]; k < offset[v + 1]; k++) {
+            int i = occurrences[k];
+            double saving = distance(prev[i], i) + distance(i, next[i]) - distance(prev[i], next[i]);
+            if (saving < keepSaving) {
+                keepSaving = saving;
+                keep = i;
+            }
+        }
+
+        for (int k = offset[v]; k < offset[v + 1]; k++) {
+            int i = occurrences[k];
+            if (i != keep) {
+                next[prev[i]] = next[i];
+                prev[next[i]] = prev[i];
+            }
+        }
+
+        if (keep != -1) {
+            kept = keep;
+        }
     }
 
-    return length;
+    std::vector<int> hamCycle;
+    int i = kept;
+    do {
+        hamCycle.push_back(eulerCycle[i]);
+        i = next[i];
+    } while (i != kept);
+
+    return hamCycle;
 }
 
-// Optimize local intersections
-void Peephole(std::vector<int>& cycle, const std::vector<Point>& points) {
-    bool improved = true;
-    for (int iteration = 0; improved && iteration < PEEPHOLE_OPT_ITERATIONS; iteration++) {
-        improved = false;
-        for (int i = 0; i < (int)cycle.size() - 1; i++) {
-            for (int j = i + 2; j < (int)cycle.size(); j++) {
-                if (j + 1 == cycle.size() && i == 0) {
-                    continue; 
+// Tour stored as a plain array with city positions: O(1) Next/Prev/Between, O(n) reversal
+class ArrayTour {
+public:
+    explicit ArrayTour(const std::vector<int>& cycle)
+        : Cities_(cycle)
+        , Position_(cycle.size())
+    {
+        for (int i = 0; i < (int)Cities_.size(); i++) {
+            Position_[Cities_[i]] = i;
+        }
+    }
+
+    int Next(int v) const {
+        int i = Position_[v] + 1;
+        return Cities_[i == (int)Cities_.size() ? 0 : i];
+    }
+
+    int Prev(int v) const {
+        int i = Position_[v];
+        return Cities_[i == 0 ? Cities_.size() - 1 : i - 1];
+    }
+
+    // Whether b lies on the path from a to c following Next
+    bool Between(int a, int b, int c) const {
+        int pa = Position_[a];
+        int pb = Position_[b];
+        int pc = Position_[c];
+        if (pa <= pc) {
+            return pa <= pb && pb <= pc;
+        }
+        return pb >= pa || pb <= pc;
+    }
+
+    // Reverses the path from..to (following Next), or the complementary path if it is shorter:
+    // both produce the same cycle
+    void Reverse(int from, int to) {
+        int n = Cities_.size();
+        int i = Position_[from];
+        int j = Position_[to];
+        int length = (j - i + n) % n + 1;
+        if (length * 2 > n) {
+            i = Position_[Next(to)];
+            j = Position_[Prev(from)];
+            length = n - length;
+        }
+
+        for (int step = 0; step < length / 2; step++) {
+            std::swap(Cities_[i], Cities_[j]);
+            Position_[Cities_[i]] = i;
+            Position_[Cities_[j]] = j;
+            i = (i + 1 == n ? 0 : i + 1);
+            j = (j == 0 ? n - 1 : j - 1);
+        }
+    }
+
+    std::vector<int> ToCycle() const {
+        return Cities_;
+    }
+
+private:
+    std::vector<int> Cities_;
+    std::vector<int> Position_;
+};
+
+// Two-level doubly-linked list: the tour is cut into ~sqrt(n) segments with a reversal bit each.
+// Next/Prev/Between are O(1), reversal splits at most two segments and flips whole segments in O(sqrt(n))
+class TwoLevelListTour {
+public:
+    explicit TwoLevelListTour(const std::vector<int>& cycle)
+        : SegmentOf_(cycle.size())
+        , IndexOf_(cycle.size())
+    {
+        Build(cycle);
+    }
+
+    int Next(int v) const {
+        const auto& segment = Segments_[SegmentOf_[v]];
+        int i = IndexOf_[v] + (segment.reversed ? -1 : 1);
+        if (i >= 0 && i < (int)segment.cities.size()) {
+            return segment.cities[i];
+        }
+
+        return First(NextSegment(SegmentOf_[v]));
+    }
+
+    int Prev(int v) const {
+        const auto& segment = Segments_[SegmentOf_[v]];
+        int i = IndexOf_[v] + (segment.reversed ? 1 : -1);
+        if (i >= 0 && i < (int)segment.cities.size()) {
+            return segment.cities[i];
+        }
+
+        return Last(PrevSegment(SegmentOf_[v]));
+    }
+
+    // Whether b lies on the path from a to c following Next
+    bool Between(int a, int b, int c) const {
+        long long ka = Key(a);
+        long long kb = Key(b);
+        long long kc = Key(c);
+        if (ka <= kc) {
+            return ka <= kb && kb <= kc;
+        }
+        return kb >= ka || kb <= kc;
+    }
+
+    // Reverses the path from..to (following Next), or the complementary path if it is shorter:
+    // both produce the same cycle
+    void Reverse(int from, int to) {
+        if (from == to || Next(to) == from) {
+            return;
+        }
+
+        // Make the path consist of whole segments
+        SplitBefore(from, -1);
+        SplitBefore(Next(to), from);
+
+        int m = Order_.size();
+        int first = Segments_[SegmentOf_[from]].rank;
+        int last = Segments_[SegmentOf_[to]].rank;
+        int count = (last - first + m) % m + 1;
+        if (count * 2 > m) {
+            first = (last + 1) % m;
+            count = m - count;
+        }
+
+        for (int i = first, j = (first + count - 1) % m, step = 0; step < count / 2; step++) {
+            std::swap(Order_[i], Order_[j]);
+            i = (i + 1 == m ? 0 : i + 1);
+            j = (j == 0 ? m - 1 : j - 1);
+        }
+        for (int i = first, step = 0; step < count; step++) {
+            auto& segment = Segments_[Order_[i]];
+            segment.reversed = !segment.reversed;
+            segment.rank = i;
+            i = (i + 1 == m ? 0 : i + 1);
+        }
+
+        // Oversized segments are halved, which slowly grows their number: start over when there are too many
+        if ((int)Order_.size() > 2 * (int)SegmentOf_.size() / SegmentSize_ + 2) {
+            Build(ToCycle());
+        }
+    }
+
+    std::vector<int> ToCycle() const {
+        std::vector<int> cycle;
+        for (int segment : Order_) {
+            const auto& cities = Segments_[segment].cities;
+            if (Segments_[segment].reversed) {
+                cycle.insert(cycle.end(), cities.rbegin(), cities.rend());
+            } else {
+                cycle.insert(cycle.end(), cities.begin(), cities.end());
+            }
+        }
+
+        return cycle;
+    }
+
+private:
+    struct Segment {
+        std::vector<int> cities;
+        bool reversed = false;
+        int rank = 0;
+    };
+
+    void Build(const std::vector<int>& cycle) {
+        int n = cycle.size();
+        SegmentSize_ = std::max(1, std::min((int)std::sqrt((double)n), n / 2));
+
+        Segments_.clear();
+        Order_.clear();
+        for (int begin = 0; begin < n; begin += SegmentSize_) {
+            int end = (n - begin < SegmentSize_ * 2 ? n : begin + SegmentSize_);
+            Segments_.push_back({std::vector<int>(cycle.begin() + begin, cycle.begin() + end), false, (int)Order_.size()});
+            Order_.push_back(Segments_.size() - 1);
+            Reindex(Order_.back(), 0);
+            if (end == n) {
+                break;
+            }
+        }
+    }
+
+    int NextSegment(int segment) const {
+        int rank = Segments_[segment].rank + 1;
+        return Order_[rank == (int)Order_.size() ? 0 : rank];
+    }
+
+    int PrevSegment(int segment) const {
+        int rank = Segments_[segment].rank;
+        return Order_[rank == 0 ? Order_.size() - 1 : rank - 1];
+    }
+
+    int First(int segment) const {
+        const auto& cities = Segments_[segment].cities;
+        return Segments_[segment].reversed ? cities.back() : cities.front();
+    }
+
+    int Last(int segment) const {
+        const auto& cities = Segments_[segment].cities;
+        return Segments_[segment].reversed ? cities.front() : cities.back();
+    }
+
+    int OrientedIndex(int v) const {
+        const auto& segment = Segments_[SegmentOf_[v]];
+        return segment.reversed ? (int)segment.cities.size() - 1 - IndexOf_[v] : IndexOf_[v];
+    }
+
+    long long Key(int v) const {
+        return (long long)Segments_[SegmentOf_[v]].rank * SegmentOf_.size() + OrientedIndex(v);
+    }
+
+    void Reindex(int segment, int from) {
+        const auto& cities = Segments_[segment].cities;
+        for (int i = from; i < (int)cities.size(); i++) {
+            SegmentOf_[cities[i]] = segment;
+            IndexOf_[cities[i]] = i;
+        }
+    }
+
+    // Drops the reversal bit by reversing the cities physically
+    void Normalize(int segment) {
+        if (Segments_[segment].reversed) {
+            std::reverse(Segments_[segment].cities.begin(), Segments_[segment].cities.end());
+            Segments_[segment].reversed = false;
+            Reindex(segment, 0);
+        }
+    }
+
+    // Makes v the first city of its segment by moving the shorter part of the segment into
+    // the neighboring segment. keepFirst (if not -1) must remain the first city of its segment
+    void SplitBefore(int v, int keepFirst) {
+        int segment = SegmentOf_[v];
+        int k = OrientedIndex(v);
+        int size = Segments_[segment].cities.size();
+        if (k == 0) {
+            return;
+        }
+
+        bool movePrefix = k <= size - k;
+        if (keepFirst != -1 && SegmentOf_[keepFirst] == segment) {
+            movePrefix = false;
+        } else if (keepFirst != -1 && First(NextSegment(segment)) == keepFirst) {
+            movePrefix = true;
+        }
+
+        Normalize(segment);
+        auto& cities = Segments_[segment].cities;
+        if (movePrefix) {
+            int target = PrevSegment(segment);
+            Normalize(target);
+            auto& targetCities = Segments_[target].cities;
+            int oldSize = targetCities.size();
+            targetCities.insert(targetCities.end(), cities.begin(), cities.begin() + k);
+            cities.erase(cities.begin(), cities.begin() + k);
+            Reindex(target, oldSize);
+            Reindex(segment, 0);
+        } else {
+            int target = NextSegment(segment);
+            Normalize(target);
+            auto& targetCities = Segments_[target].cities;
+            targetCities.insert(targetCities.begin(), cities.begin() + k, cities.end());
+            cities.resize(k);
+            Reindex(target, 0);
+        }
+
+        int target = movePrefix ? PrevSegment(segment) : NextSegment(segment);
+        if ((int)Segments_[target].cities.size() > SegmentSize_ * 2) {
+            Halve(target);
+        }
+    }
+
+    // Moves the second half of a normalized segment into a new segment right after it
+    void Halve(int segment) {
+        auto& cities = Segments_[segment].cities;
+        int half = cities.size() / 2;
+        std::vector<int> tail(cities.begin() + half, cities.end());
+        cities.resize(half);
+        Segments_.push_back({std::move(tail), false, 0});
+
+        int part = Segments_.size() - 1;
+        int rank = Segments_[segment].rank + 1;
+        Order_.insert(Order_.begin() + rank, part);
+        for (int i = rank; i < (int)Order_.size(); i++) {
+            Segments_[Order_[i]].rank = i;
+        }
+        Reindex(part, 0);
+    }
+
+    int SegmentSize_ = 0;
+    std::vector<Segment> Segments_;
+    std::vector<int> Order_;
+    std::vector<int> SegmentOf_;
+    std::vector<int> IndexOf_;
+};
+
+// 2-opt and Or-opt driven by candidate neighbor lists. Cities without an improving move
+// drop out of the active queue (don't-look bits) until one of their tour edges changes.
+// With Lin-Kernighan enabled, 2-opt is generalized to a variable-depth chain of flips
+template <typename Tour>
+class LocalSearch {
+public:
+    LocalSearch(const CityCoordinates& coordinates, const std::vector<std::vector<int>>& neighbors,
+                bool useLinKernighan = false)
+        : Coordinates_(coordinates)
+        , Neighbors_(neighbors)
+        , NeighborDistances_(neighbors.size())
+        , UseLinKernighan_(useLinKernighan)
+    {
+        // Neighbor lists are scanned on every move evaluation, so their distances are computed once
+        size_t maxNeighbors = 0;
+        for (int v = 0; v < (int)neighbors.size(); v++) {
+            NeighborDistances_[v].resize(neighbors[v].size());
+            Coordinates_.Distances(v, neighbors[v].data(), neighbors[v].size(), NeighborDistances_[v].data());
+            maxNeighbors = std::max(maxNeighbors, neighbors[v].size());
+        }
+
+        // Two tour neighbors per candidate at most
+        Starts_.resize(2 * maxNeighbors);
+        Ends_.resize(2 * maxNeighbors);
+        FirstDistances_.resize(2 * maxNeighbors);
+        SecondDistances_.resize(2 * maxNeighbors);
+    }
+
+    // Moves never remove the edge (a, b): lets a tour segment be optimized as a path with fixed ends
+    void SetFixedEdge(int a, int b) {
+        FixedEdge_ = {a, b};
+    }
+
+    // Cities left in the queue after the deadline are dropped: the tour stays valid, just not fully optimized
+    void SetDeadline(std::chrono::steady_clock::time_point deadline) {
+        Deadline_ = deadline;
+    }
+
+    void Optimize(std::vector<int>& cycle) {
+        Optimize(cycle, cycle);
+    }
+
+    // Only cities from activeCities are examined initially, the rest are woken up by applied moves
+    void Optimize(std::vector<int>& cycle, const std::vector<int>& activeCities) {
+        int n = cycle.size();
+        if (n < 8) {
+            return;
+        }
+
+        Tour tour(cycle);
+        Tour_ = &tour;
+
+        InQueue_.assign(n, false);
+        Queue_.clear();
+        for (int v : activeCities) {
+            Activate(v);
+        }
+
+        int processed = 0;
+        while (!Queue_.empty()) {
+            if (++processed % DEADLINE_CHECK_INTERVAL == 0 && std::chrono::steady_clock::now() > Deadline_) {
+                break;
+            }
+
+            int v = Queue_.front();
+            Queue_.pop_front();
+            InQueue_[v] = false;
+
+            while (ImproveCity(v)) {
+            }
+        }
+
+        cycle = tour.ToCycle();
+        Tour_ = nullptr;
+    }
+
+private:
+    double Distance(int a, int b) const {
+        return Coordinates_.Distance(a, b);
+    }
+
+    // Number of leading neighbors of v closer than limit: the list is sorted, only these can give an improving move
+    int CountCloser(int v, double limit) const {
+        const auto& distances = NeighborDistances_[v];
+        int count = 0;
+        while (count < (int)distances.size() && distances[count] < limit - EPS) {
+            count++;
+        }
+        return count;
+    }
+
+    bool IsFixed(int a, int b) const {
+        return (a == FixedEdge_.first && b == FixedEdge_.second) || (a == FixedEdge_.second && b == FixedEdge_.first);
+    }
+
+    void Activate(int v) {
+        if (!InQueue_[v]) {
+            InQueue_[v] = true;
+            Queue_.push_back(v);
+        }
+    }
+
+    // Replaces edges (a, b) and (c, d) with (a, c) and (b, d). Both edges must be traversed
+    // in the same direction: b == Next(a) && d == Next(c) or b == Prev(a) && d == Prev(c)
+    void Flip(int a, int b, int c, int d) {
+        if (Tour_->Next(a) == b) {
+            Tour_->Reverse(b, c);
+        } else {
+            Tour_->Reverse(a, d);
+        }
+    }
+
+    void MakeTwoOptMove(int a, int b, int c, int d) {
+        Flip(a, b, c, d);
+
+        Activate(a);
+        Activate(b);
+        Activate(c);
+        Activate(d);
+    }
+
+    bool ImproveCity(int a) {
+        if (UseLinKernighan_) {
+            return TryLinKernighan(a) || TryOrOpt(a);
+        }
+
+        return TryTwoOpt(a, true) || TryTwoOpt(a, false) || TryOrOpt(a);
+    }
+
+    bool TryTwoOpt(int a, bool forward) {
+        int b = forward ? Tour_->Next(a) : Tour_->Prev(a);
+        if (IsFixed(a, b)) {
+            return false;
+        }
+        double removed = Distance(a, b);
+
+        // Distances (b, d) and (c, d) of all candidates in two batches
+        const auto& near = Neighbors_[a];
+        int count = CountCloser(a, removed);
+        for (int i = 0; i < count; i++) {
+            Ends_[i] = forward ? Tour_->Next(near[i]) : Tour_->Prev(near[i]);
+        }
+        Coordinates_.Distances(b, Ends_.data(), count, FirstDistances_.data());
+        Coordinates_.Distances(near.data(), Ends_.data(), count, SecondDistances_.data());
+
+        for (int i = 0; i < count; i++) {
+            int c = near[i];
+            int d = Ends_[i];
+            if (c == b || d == a || IsFixed(c, d)) {
+                continue;
+            }
+
+            double delta = NeighborDistances_[a][i] + FirstDistances_[i] - removed - SecondDistances_[i];
+            if (delta < -EPS) {
+                MakeTwoOptMove(a, b, c, d);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Moves a segment of up to OR_OPT_MAX_SEGMENT cities that starts or ends at a
+    // next to one of a's neighbors, possibly reversed
+    bool TryOrOpt(int a) {
+        int n = InQueue_.size();
+        for (int length = 1; length <= OR_OPT_MAX_SEGMENT && length + 3 <= n; length++) {
+            for (int side = 0; side < (length == 1 ? 1 : 2); side++) {
+                // Segment first..last in the Next direction, a is one of its ends
+                int first = a;
+                int last = a;
+                for (int i = 1; i < length; i++) {
+                    if (side == 0) {
+                        last = Tour_->Next(last);
+                    } else {
+                        first = Tour_->Prev(first);
+                    }
+                }
+
+                int prev = Tour_->Prev(first);
+                int next = Tour_->Next(last);
+                if (IsFixed(prev, first) || IsFixed(last, next)) {
+                    continue;
+                }
+
+                double removeGain = Distance(prev, first) + Distance(last, next) - Distance(prev, next);
+                if (removeGain <= EPS) {
+                    continue;
+                }
+
+                // Insert between c and either of its tour neighbors e, a becomes adjacent to c. Distances (other, e)
+                // and (c, e) of all candidates in two batches
+                const auto& near = Neighbors_[a];
+                int count = CountCloser(a, removeGain);
+                int other = (a == first ? last : first);
+                for (int i = 0; i < count; i++) {
+                    Starts_[2 * i] = Starts_[2 * i + 1] = near[i];
+                    Ends_[2 * i] = Tour_->Next(near[i]);
+                    Ends_[2 * i + 1] = Tour_->Prev(near[i]);
                 }
+                Coordinates_.Distances(other, Ends_.data(), 2 * count, FirstDistances_.data());
+                Coordinates_.Distances(Starts_.data(), Ends_.data(), 2 * count, SecondDistances_.data());
 
-                int i1 = cycle[i];
-                int i2 = cycle[i + 1];
-                int j1 = cycle[j];
-                int j2 = cycle[(j + 1) % cycle.size()];
+                for (int i = 0; i < count; i++) {
+                    int c = near[i];
+                    if (Tour_->Between(first, c, last)) {
+                        continue;
+                    }
 
-                double currentDist = EuclideanDistance(points[i1], points[i2]) + 
-                                     EuclideanDistance(points[j1], points[j2]);
-                double newDist = EuclideanDistance(points[i1], points[j1]) + 
-                                 EuclideanDistance(points[i2], points[j2]);
+                    for (int j = 2 * i; j < 2 * i + 2; j++) {
+                        int e = Ends_[j];
+                        if (Tour_->Between(first, e, last) || IsFixed(c, e)) {
+                            continue;
+                        }
 
-                if (newDist < currentDist - EPS) {
-                    std::reverse(cycle.begin() + i + 1, cycle.begin() + j + 1);
-                    improved = true;
+                        double delta = NeighborDistances_[a][i] + FirstDistances_[j] - SecondDistances_[j] - removeGain;
+                        if (delta < -EPS) {
+                            MakeOrOptMove(first, last, prev, next, c, e, a);
+                            return true;
+                        }
+                    }
                 }
             }
         }
+
+        return false;
     }
-}
 
-std::vector<int> ChristofidesAlgorithm(const std::vector<Point>& points) {    
-    std::cout << "Running base algorithm...\n";
+    // Moves segment first..last (prev and next are its tour neighbors) between c and e,
+    // so that the segment end `near` becomes adjacent to c
+    void MakeOrOptMove(int first, int last, int prev, int next, int c, int e, int near) {
+        // Orient the target edge so that e == Next(c)
+        if (Tour_->Next(c) != e) {
+            std::swap(c, e);
+            near = (near == first ? last : first);
+        }
+
+        // Expressed as three 2-opt moves:
+        // prev [first..last] next .. c e -> prev c .. next [last..first] e -> prev next .. c [last..first] e
+        MakeTwoOptMove(prev, first, c, e);
+        MakeTwoOptMove(prev, c, next, last);
+        if (near == first) {
+            MakeTwoOptMove(c, last, first, e);
+        }
+    }
 
-    auto mst = BuildMST(points);
+    bool TryLinKernighan(int t1) {
+        return TryLinKernighan(t1, Tour_->Next(t1)) || TryLinKernighan(t1, Tour_->Prev(t1));
+    }
 
-    auto oddVertices = FindOddDegreeVertices(mst, points.size());
-    auto matching = GreedyMinimumMatching(oddVertices, points);
+    // Variable-depth search: edge (t1, t2) is broken, then every step adds (t2, t3), breaks (t3, t4)
+    // and closes the tour with (t4, t1) by a single flip, t4 becoming the new t2. The chain is cut back
+    // to its most profitable prefix. Alternatives are tried only on the first level
+    bool TryLinKernighan(int t1, int t2) {
+        double gain = Distance(t1, t2);
+        if (IsFixed(t1, t2)) {
+            return false;
+        }
 
-    auto graph = BuildAdjacencyList(std::move(mst), points.size());
-    auto eulerCycle = FindEulerianCycle(graph, 0);
-    auto hamCycle = EulerianToHamiltonian(eulerCycle);
+        std::vector<std::pair<double, int>> alternatives;
+        int count = FindLinKernighanT4s(t1, t2, gain);
+        for (int i = 0; i < count; i++) {
+            if (Ends_[i] != -1) {
+                alternatives.push_back({FirstDistances_[i] - NeighborDistances_[t2][i], Neighbors_[t2][i]});
+            }
+        }
+        std::sort(alternatives.begin(), alternatives.end(), std::greater<>());
+        alternatives.resize(std::min<int>(alternatives.size(), LK_BREADTH));
 
-    std::cout << "Initial Hamiltonian cycle length: " << CalculateCycleLength(hamCycle, points) << '\n';
-    std::cout << "Optimizing with 2-opt...\n";
-    Peephole(hamCycle, points);
-    std::cout << "After 2-opt: " << CalculateCycleLength(hamCycle, points) << '\n';
+        for (const auto& [lookahead, firstT3] : alternatives) {
+            std::vector<std::array<int, 4>> flips;
+            std::vector<std::pair<int, int>> added;
+            double chainGain = gain;
+            double bestGain = 0.0;
+            int bestDepth = 0;
 
-    return hamCycle;
-}
+            int current = t2;
+            int t3 = firstT3;
+            while (t3 != -1) {
+                int t4 = NextLinKernighanT4(t1, current, t3);
+                Flip(t1, current, t4, t3);
+                flips.push_back({t1, current, t4, t3});
+                added.push_back(std::minmax(current, t3));
 
-int main() {
-    std::ifstream fin("input.txt");
-    std::vector<Point> points;
+                chainGain += Distance(t3, t4) - Distance(current, t3);
+                double closedGain = chainGain - Distance(t4, t1);
+                if (closedGain > bestGain + EPS) {
+                    bestGain = closedGain;
+                    bestDepth = flips.size();
+                }
 
-    int id = 0;
-    double x = 0;
-    double y = 0;
-    while (fin >> id >> x >> y) {
-        points.push_back({id - 1, x, y});
+                current = t4;
+                t3 = (int)flips.size() < LK_MAX_DEPTH ? ChooseLinKernighanT3(t1, current, chainGain, added) : -1;
+            }
+
+            while ((int)flips.size() > bestDepth) {
+                auto [a, b, c, d] = flips.back();
+                Flip(a, c, b, d);
+                flips.pop_back();
+            }
+
+            if (bestDepth > 0) {
+                for (const auto& flip : flips) {
+                    for (int v : flip) {
+                        Activate(v);
+                    }
+                }
+                return true;
+            }
+        }
+
+        return false;
     }
-    fin.close();
-    std::cout << "Graph: " << points.size() << " vertices\n\n";
 
-    auto cycle = ChristofidesAlgorithm(points);
+    // t4 is the tour neighbor of t3 such that a flip keeps t1 adjacent to t4, -1 if the move degenerates
+    int NextLinKernighanT4(int t1, int t2, int t3) const {
+        if (t3 == t1 || t3 == Tour_->Next(t2) || t3 == Tour_->Prev(t2)) {
+            return -1;
+        }
+
+        int t4 = Tour_->Next(t1) == t2 ? Tour_->Prev(t3) : Tour_->Next(t3);
+        return IsFixed(t3, t4) ? -1 : t4;
+    }
+
+    // For the candidates t3 of t2 closer than gain: t4 into Ends_ (-1 for none) and the distance (t3, t4) into
+    // FirstDistances_, computed in one batch. Returns the number of candidates
+    int FindLinKernighanT4s(int t1, int t2, double gain) {
+        const auto& near = Neighbors_[t2];
+        int count = CountCloser(t2, gain);
+        for (int i = 0; i < count; i++) {
+            Ends_[i] = NextLinKernighanT4(t1, t2, near[i]);
+            Starts_[i] = Ends_[i] == -1 ? near[i] : Ends_[i];
+        }
+        Coordinates_.Distances(near.data(), Starts_.data(), count, FirstDistances_.data());
+        return count;
+    }
+
+    int ChooseLinKernighanT3(int t1, int t2, double chainGain, const std::vector<std::pair<int, int>>& added) {
+        int best = -1;
+        double bestLookahead = std::numeric_limits<double>::lowest();
+        int count = FindLinKernighanT4s(t1, t2, chainGain);
+        for (int i = 0; i < count; i++) {
+            int t3 = Neighbors_[t2][i];
+            int t4 = Ends_[i];
+            if (t4 == -1) {
+                continue;
+            }
+
+            // Edges added by the chain are never broken again
+            std::pair<int, int> broken = std::minmax(t3, t4);
+            if (std::find(added.begin(), added.end(), broken) != added.end()) {
+                continue;
+            }
+
+            double lookahead = FirstDistances_[i] - NeighborDistances_[t2][i];
+            if (lookahead > bestLookahead) {
+                bestLookahead = lookahead;
+                best = t3;
+            }
+        }
+
+        return best;
+    }
+
+    const CityCoordinates& Coordinates_;
+    const std::vector<std::vector<int>>& Neighbors_;
+    std::vector<std::vector<Real>> NeighborDistances_;
+    bool UseLinKernighan_;
+    std::vector<int> Starts_;
+    std::vector<int> Ends_;
+    std::vector<Real> FirstDistances_;
+    std::vector<Real> SecondDistances_;
+    std::pair<int, int> FixedEdge_ = {-1, -1};
+    std::chrono::steady_clock::time_point Deadline_ = std::chrono::steady_clock::time_point::max();
+
+    Tour* Tour_ = nullptr;
+    std::vector<bool> InQueue_;
+    std::deque<int> Queue_;
+};
+
+// Maximum weight matching of maximum cardinality in a general graph: Edmonds' blossom algorithm
+// with dual variables in the O(n * m * ...) primal-dual formulation of Galil. Integer weights
+// must be even so that all dual updates stay integral
+class WeightedMatching {
+public:
+    struct WeightedEdge {
+        int u, v;
+        long long weight;
+    };
+
+    WeightedMatching(int vertexCount, std::vector<WeightedEdge> edges)
+        : N_(vertexCount)
+        , Edges_(std::move(edges))
+        , Endpoint_(2 * Edges_.size())
+        , NeighborEnds_(N_)
+        , Mate_(N_, -1)
+        , Label_(2 * N_, 0)
+        , LabelEnd_(2 * N_, -1)
+        , InBlossom_(N_)
+        , BlossomParent_(2 * N_, -1)
+        , BlossomChilds_(2 * N_)
+        , BlossomBase_(2 * N_, -1)
+        , BlossomEndps_(2 * N_)
+        , BestEdge_(2 * N_, -1)
+        , BlossomBestEdges_(2 * N_)
+        , HasBlossomBestEdges_(2 * N_, false)
+        , DualVar_(2 * N_, 0)
+        , AllowEdge_(Edges_.size(), false)
+        , BestEdgeTo_(2 * N_, -1)
+    {
+        long long maxWeight = 0;
+        for (int k = 0; k < (int)Edges_.size(); k++) {
+            maxWeight = std::max(maxWeight, Edges_[k].weight);
+            Endpoint_[2 * k] = Edges_[k].u;
+            Endpoint_[2 * k + 1] = Edges_[k].v;
+            NeighborEnds_[Edges_[k].u].push_back(2 * k + 1);
+            NeighborEnds_[Edges_[k].v].push_back(2 * k);
+        }
+
+        for (int v = 0; v < N_; v++) {
+            InBlossom_[v] = v;
+            BlossomBase_[v] = v;
+            DualVar_[v] = maxWeight;
+        }
+        for (int b = 2 * N_ - 1; b >= N_; b--) {
+            UnusedBlossoms_.push_back(b);
+        }
+    }
+
+    // mate[v] is the vertex matched to v, -1 if v stays unmatched
+    std::vector<int> Solve() {
+        for (int stage = 0; stage < N_; stage++) {
+            if (!RunStage()) {
+                break;
+            }
+
+            for (int b = N_; b < 2 * N_; b++) {
+                if (BlossomParent_[b] == -1 && BlossomBase_[b] >= 0 && Label_[b] == 1 && DualVar_[b] == 0) {
+                    ExpandBlossom(b, true);
+                }
+            }
+        }
+
+        std::vector<int> mate(N_, -1);
+        for (int v = 0; v < N_; v++) {
+            if (Mate_[v] >= 0) {
+                mate[v] = Endpoint_[Mate_[v]];
+            }
+        }
+
+        return mate;
+    }
+
+private:
+    long long Slack(int k) const {
+        return DualVar_[Edges_[k].u] + DualVar_[Edges_[k].v] - 2 * Edges_[k].weight;
+    }
+
+    template <typename Callback>
+    void ForEachLeaf(int b, Callback&& callback) const {
+        if (b < N_) {
+            callback(b);
+            return;
+        }
+
+        for (int t : BlossomChilds_[b]) {
+            ForEachLeaf(t, callback);
+        }
+    }
+
+    // Python-style indexing into the cyclic child list of a blossom
+    static int Wrap(int j, int size) {
+        return (j % size + size) % size;
+    }
+
+    void AssignLabel(int w, int t, int p) {
+        int b = InBlossom_[w];
+        Label_[w] = Label_[b] = t;
+        LabelEnd_[w] = LabelEnd_[b] = p;
+        BestEdge_[w] = BestEdge_[b] = -1;
+        if (t == 1) {
+            ForEachLeaf(b, [&](int v) { Queue_.push_back(v); });
+        } else {
+            int base = BlossomBase_[b];
+            AssignLabel(Endpoint_[Mate_[base]], 1, Mate_[base] ^ 1);
+        }
+    }
+
+    // Traces back from v and w to find either a new blossom base or an augmenting path (-1)
+    int ScanBlossom(int v, int w) {
+        std::vector<int> path;
+        int base = -1;
+        while (v != -1 || w != -1) {
+            int b = InBlossom_[v];
+            if (Label_[b] & 4) {
+                base = BlossomBase_[b];
+                break;
+            }
+
+            path.push_back(b);
+            Label_[b] = 5;
+            if (LabelEnd_[b] == -1) {
+                v = -1;
+            } else {
+                v = Endpoint_[LabelEnd_[b]];
+                b = InBlossom_[v];
+                v = Endpoint_[LabelEnd_[b]];
+            }
+
+            if (w != -1) {
+                std::swap(v, w);
+            }
+        }
+
+        for (int b : path) {
+            Label_[b] = 1;
+        }
+
+        return base;
+    }
+
+    void AddBlossom(int base, int k) {
+        int v = Edges_[k].u;
+        int w = Edges_[k].v;
+        int bb = InBlossom_[base];
+        int bv = InBlossom_[v];
+        int bw = InBlossom_[w];
+
+        int b = UnusedBlossoms_.back();
+        UnusedBlossoms_.pop_back();
+        BlossomBase_[b] = base;
+        BlossomParent_[b] = -1;
+        BlossomParent_[bb] = b;
+
+        auto& path = BlossomChilds_[b];
+        auto& endps = BlossomEndps_[b];
+        path.clear();
+        endps.clear();
+        while (bv != bb) {
+            BlossomParent_[bv] = b;
+            path.push_back(bv);
+            endps.push_back(LabelEnd_[bv]);
+            v = Endpoint_[LabelEnd_[bv]];
+            bv = InBlossom_[v];
+        }
+        path.push_back(bb);
+        std::reverse(path.begin(), path.end());
+        std::reverse(endps.begin(), endps.end());
+        endps.push_back(2 * k);
+        while (bw != bb) {
+            BlossomParent_[bw] = b;
+            path.push_back(bw);
+            endps.push_back(LabelEnd_[bw] ^ 1);
+            w = Endpoint_[LabelEnd_[bw]];
+            bw = InBlossom_[w];
+        }
+
+        Label_[b] = 1;
+        LabelEnd_[b] = LabelEnd_[bb];
+        DualVar_[b] = 0;
+        ForEachLeaf(b, [&](int leaf) {
+            if (Label_[InBlossom_[leaf]] == 2) {
+                Queue_.push_back(leaf);
+            }
+            InBlossom_[leaf] = b;
+        });
+
+        // Least-slack edges from the new blossom to every neighboring S-blossom
+        std::vector<int> touched;
+        auto consider = [&](int edge) {
+            int i = Edges_[edge].u;
+            int j = Edges_[edge].v;
+            if (InBlossom_[j] == b) {
+                std::swap(i, j);
+            }
+
+            int bj = InBlossom_[j];
+            if (bj != b && Label_[bj] == 1 && (BestEdgeTo_[bj] == -1 || Slack(edge) < Slack(BestEdgeTo_[bj]))) {
+                if (BestEdgeTo_[bj] == -1) {
+                    touched.push_back(bj);
+                }
+                BestEdgeTo_[bj] = edge;
+            }
+        };
+
+        for (int child : path) {
+            if (!HasBlossomBestEdges_[child]) {
+                ForEachLeaf(child, [&](int leaf) {
+                    for (int p : NeighborEnds_[leaf]) {
+                        consider(p / 2);
+                    }
+                });
+            } else {
+                for (int edge : BlossomBestEdges_[child]) {
+                    consider(edge);
+                }
+            }
+
+            HasBlossomBestEdges_[child] = false;
+            BlossomBestEdges_[child].clear();
+            BestEdge_[child] = -1;
+        }
+
+        auto& bestEdges = BlossomBestEdges_[b];
+        bestEdges.clear();
+        HasBlossomBestEdges_[b] = true;
+        BestEdge_[b] = -1;
+        for (int bj : touched) {
+            int edge = BestEdgeTo_[bj];
+            BestEdgeTo_[bj] = -1;
+            bestEdges.push_back(edge);
+            if (BestEdge_[b] == -1 || Slack(edge) < Slack(BestEdge_[b])) {
+                BestEdge_[b] = edge;
+            }
+        }
+    }
+
+    void ExpandBlossom(int b, bool endStage) {
+        for (int s : BlossomChilds_[b]) {
+            BlossomParent_[s] = -1;
+            if (s < N_) {
+                InBlossom_[s] = s;
+            } else if (endStage && DualVar_[s] == 0) {
+                ExpandBlossom(s, endStage);
+            } else {
+                ForEachLeaf(s, [&](int leaf) { InBlossom_[leaf] = s; });
+            }
+        }
+
+        if (!endStage && Label_[b] == 2) {
+            const auto& childs = BlossomChilds_[b];
+            const auto& endps = BlossomEndps_[b];
+            int size = childs.size();
+
+            int entryChild = InBlossom_[Endpoint_[LabelEnd_[b] ^ 1]];
+            int j = std::find(childs.begin(), childs.end(), entryChild) - childs.begin();
+            int jStep = 0;
+            int endpTrick = 0;
+            if (j & 1) {
+                j -= size;
+                jStep = 1;
+                endpTrick = 0;
+            } else {
+                jStep = -1;
+                endpTrick = 1;
+            }
+
+            // Relabel the T-sub-blossoms on the even-length path from the entry child to the base
+            int p = LabelEnd_[b];
+            while (j != 0) {
+                Label_[Endpoint_[p ^ 1]] = 0;
+                Label_[Endpoint_[endps[Wrap(j - endpTrick, size)] ^ endpTrick ^ 1]] = 0;
+                AssignLabel(Endpoint_[p ^ 1], 2, p);
+                AllowEdge_[endps[Wrap(j - endpTrick, size)] / 2] = true;
+                j += jStep;
+                p = endps[Wrap(j - endpTrick, size)] ^ endpTrick;
+                AllowEdge_[p / 2] = true;
+                j += jStep;
+            }
+
+            int bv = childs[Wrap(j, size)];
+            Label_[Endpoint_[p ^ 1]] = Label_[bv] = 2;
+            LabelEnd_[Endpoint_[p ^ 1]] = LabelEnd_[bv] = p;
+            BestEdge_[bv] = -1;
+
+            j += jStep;
+            while (childs[Wrap(j, size)] != entryChild) {
+                bv = childs[Wrap(j, size)];
+                if (Label_[bv] == 1) {
+                    j += jStep;
+                    continue;
+                }
+
+                int reachable = -1;
+                ForEachLeaf(bv, [&](int leaf) {
+                    if (reachable == -1 && Label_[leaf] != 0) {
+                        reachable = leaf;
+                    }
+                });
+
+                if (reachable != -1) {
+                    Label_[reachable] = 0;
+                    Label_[Endpoint_[Mate_[BlossomBase_[bv]]]] = 0;
+                    AssignLabel(reachable, 2, LabelEnd_[reachable]);
+                }
+                j += jStep;
+            }
+        }
+
+        Label_[b] = LabelEnd_[b] = -1;
+        BlossomChilds_[b].clear();
+        BlossomEndps_[b].clear();
+        BlossomBase_[b] = -1;
+        BlossomBestEdges_[b].clear();
+        HasBlossomBestEdges_[b] = false;
+        BestEdge_[b] = -1;
+        UnusedBlossoms_.push_back(b);
+    }
+
+    // Swaps matched and unmatched edges along the even path from v to the base of blossom b
+    void AugmentBlossom(int b, int v) {
+        int t = v;
+        while (BlossomParent_[t] != b) {
+            t = BlossomParent_[t];
+        }
+        if (t >= N_) {
+            AugmentBlossom(t, v);
+        }
+
+        auto& childs = BlossomChilds_[b];
+        auto& endps = BlossomEndps_[b];
+        int size = childs.size();
+        int i = std::find(childs.begin(), childs.end(), t) - childs.begin();
+        int j = i;
+        int jStep = 0;
+        int endpTrick = 0;
+        if (i & 1) {
+            j -= size;
+            jStep = 1;
+            endpTrick = 0;
+        } else {
+            jStep = -1;
+            endpTrick = 1;
+        }
+
+        while (j != 0) {
+            j += jStep;
+            t = childs[Wrap(j, size)];
+            int p = endps[Wrap(j - endpTrick, size)] ^ endpTrick;
+            if (t >= N_) {
+                AugmentBlossom(t, Endpoint_[p]);
+            }
+            j += jStep;
+            t = childs[Wrap(j, size)];
+            if (t >= N_) {
+                AugmentBlossom(t, Endpoint_[p ^ 1]);
+            }
+            Mate_[Endpoint_[p]] = p ^ 1;
+            Mate_[Endpoint_[p ^ 1]] = p;
+        }
+
+        std::rotate(childs.begin(), childs.begin() + i, childs.end());
+        std::rotate(endps.begin(), endps.begin() + i, endps.end());
+        BlossomBase_[b] = BlossomBase_[childs[0]];
+    }
+
+    void AugmentMatching(int k) {
+        int v = Edges_[k].u;
+        int w = Edges_[k].v;
+        for (auto [s, p] : {std::pair<int, int>{v, 2 * k + 1}, std::pair<int, int>{w, 2 * k}}) {
+            while (true) {
+                int bs = InBlossom_[s];
+                if (bs >= N_) {
+                    AugmentBlossom(bs, s);
+                }
+                Mate_[s] = p;
+                if (LabelEnd_[bs] == -1) {
+                    break;
+                }
+
+                int t = Endpoint_[LabelEnd_[bs]];
+                int bt = InBlossom_[t];
+                s = Endpoint_[LabelEnd_[bt]];
+                int j = Endpoint_[LabelEnd_[bt] ^ 1];
+                if (bt >= N_) {
+                    AugmentBlossom(bt, j);
+                }
+                Mate_[j] = LabelEnd_[bt];
+                p = LabelEnd_[bt] ^ 1;
+            }
+        }
+    }
+
+    // Grows alternating trees from all free vertices until one augmentation; false if none exists
+    bool RunStage() {
+        std::fill(Label_.begin(), Label_.end(), 0);
+        std::fill(BestEdge_.begin(), BestEdge_.end(), -1);
+        for (int b = N_; b < 2 * N_; b++) {
+            BlossomBestEdges_[b].clear();
+            HasBlossomBestEdges_[b] = false;
+        }
+        std::fill(AllowEdge_.begin(), AllowEdge_.end(), false);
+        Queue_.clear();
+
+        for (int v = 0; v < N_; v++) {
+            if (Mate_[v] == -1 && Label_[InBlossom_[v]] == 0) {
+                AssignLabel(v, 1, -1);
+            }
+        }
+
+        while (true) {
+            while (!Queue_.empty()) {
+                int v = Queue_.back();
+                Queue_.pop_back();
+
+                for (int p : NeighborEnds_[v]) {
+                    int k = p / 2;
+                    int w = Endpoint_[p];
+                    if (InBlossom_[v] == InBlossom_[w]) {
+                        continue;
+                    }
+
+                    long long kSlack = 0;
+                    if (!AllowEdge_[k]) {
+                        kSlack = Slack(k);
+                        if (kSlack <= 0) {
+                            AllowEdge_[k] = true;
+                        }
+                    }
+
+                    if (AllowEdge_[k]) {
+                        if (Label_[InBlossom_[w]] == 0) {
+                            AssignLabel(w, 2, p ^ 1);
+                        } else if (Label_[InBlossom_[w]] == 1) {
+                            int base = ScanBlossom(v, w);
+                            if (base >= 0) {
+                                AddBlossom(base, k);
+                            } else {
+                                AugmentMatching(k);
+                                return true;
+                            }
+                        } else if (Label_[w] == 0) {
+                            Label_[w] = 2;
+                            LabelEnd_[w] = p ^ 1;
+                        }
+                    } else if (Label_[InBlossom_[w]] == 1) {
+                        int b = InBlossom_[v];
+                        if (BestEdge_[b] == -1 || kSlack < Slack(BestEdge_[b])) {
+                            BestEdge_[b] = k;
+                        }
+                    } else if (Label_[w] == 0) {
+                        if (BestEdge_[w] == -1 || kSlack < Slack(BestEdge_[w])) {
+                            BestEdge_[w] = k;
+                        }
+                    }
+                }
+            }
+
+            // No tight edge left: pick the smallest dual change that creates one
+            int deltaType = -1;
+            long long delta = 0;
+            int deltaEdge = -1;
+            int deltaBlossom = -1;
+            for (int v = 0; v < N_; v++) {
+                if (Label_[InBlossom_[v]] == 0 && BestEdge_[v] != -1) {
+                    long long d = Slack(BestEdge_[v]);
+                    if (deltaType == -1 || d < delta) {
+                        delta = d;
+                        deltaType = 2;
+                        deltaEdge = BestEdge_[v];
+                    }
+                }
+            }
+            for (int b = 0; b < 2 * N_; b++) {
+                if (BlossomParent_[b] == -1 && Label_[b] == 1 && BestEdge_[b] != -1) {
+                    long long d = Slack(BestEdge_[b]) / 2;
+                    if (deltaType == -1 || d < delta) {
+                        delta = d;
+                        deltaType = 3;
+                        deltaEdge = BestEdge_[b];
+                    }
+                }
+            }
+            for (int b = N_; b < 2 * N_; b++) {
+                if (BlossomBase_[b] >= 0 && BlossomParent_[b] == -1 && Label_[b] == 2 &&
+                    (deltaType == -1 || DualVar_[b] < delta)) {
+                    delta = DualVar_[b];
+                    deltaType = 4;
+                    deltaBlossom = b;
+                }
+            }
+            if (deltaType == -1) {
+                deltaType = 1;
+                delta = std::max(0LL, *std::min_element(DualVar_.begin(), DualVar_.begin() + N_));
+            }
+
+            for (int v = 0; v < N_; v++) {
+                if (Label_[InBlossom_[v]] == 1) {
+                    DualVar_[v] -= delta;
+                } else if (Label_[InBlossom_[v]] == 2) {
+                    DualVar_[v] += delta;
+                }
+            }
+            for (int b = N_; b < 2 * N_; b++) {
+                if (BlossomBase_[b] >= 0 && BlossomParent_[b] == -1) {
+                    if (Label_[b] == 1) {
+                        DualVar_[b] += delta;
+                    } else if (Label_[b] == 2) {
+                        DualVar_[b] -= delta;
+                    }
+                }
+            }
+
+            if (deltaType == 1) {
+                return false;
+            } else if (deltaType == 2) {
+                AllowEdge_[deltaEdge] = true;
+                int i = Edges_[deltaEdge].u;
+                if (Label_[InBlossom_[i]] == 0) {
+                    i = Edges_[deltaEdge].v;
+                }
+                Queue_.push_back(i);
+            } else if (deltaType == 3) {
+                AllowEdge_[deltaEdge] = true;
+                Queue_.push_back(Edges_[deltaEdge].u);
+            } else {
+                ExpandBlossom(deltaBlossom, false);
+            }
+        }
+    }
+
+    int N_;
+    std::vector<WeightedEdge> Edges_;
+    std::vector<int> Endpoint_;
+    std::vector<std::vector<int>> NeighborEnds_;
+    std::vector<int> Mate_;
+    std::vector<int> Label_;
+    std::vector<int> LabelEnd_;
+    std::vector<int> InBlossom_;
+    std::vector<int> BlossomParent_;
+    std::vector<std::vector<int>> BlossomChilds_;
+    std::vector<int> BlossomBase_;
+    std::vector<std::vector<int>> BlossomEndps_;
+    std::vector<int> BestEdge_;
+    std::vector<std::vector<int>> BlossomBestEdges_;
+    std::vector<bool> HasBlossomBestEdges_;
+    std::vector<int> UnusedBlossoms_;
+    std::vector<long long> DualVar_;
+    std::vector<bool> AllowEdge_;
+    std::vector<int> BestEdgeTo_;
+    std::vector<int> Queue_;
+};
+
+// Minimum weight perfect matching of a cluster restricted to k nearest neighbors inside it.
+// Vertices left unmatched when the sparse graph has no perfect matching are returned separately
+void MatchCluster(const std::vector<int>& cluster, const std::vector<Point>& points,
+                  std::vector<Edge>& matching, std::vector<int>& unmatched) {
+    int n = cluster.size();
+    std::vector<Point> clusterPoints;
+    for (int v : cluster) {
+        clusterPoints.push_back(points[v]);
+    }
+
+    auto neighbors = BuildNeighborLists(clusterPoints, MATCHING_NEIGHBOR_LIST_SIZE, 1);
+
+    // Max weight of maximum cardinality with weights (limit - length) is a min length perfect matching
+    std::vector<WeightedMatching::WeightedEdge> edges;
+    long long limit = 0;
+    for (int v = 0; v < n; v++) {
+        for (int u : neighbors[v]) {
+            bool duplicate = v > u && std::find(neighbors[u].begin(), neighbors[u].end(), v) != neighbors[u].end();
+            if (!duplicate) {
+                long long length = std::llround(EuclideanDistance(clusterPoints[v], clusterPoints[u]) * MATCHING_WEIGHT_SCALE);
+                edges.push_back({v, u, length});
+                limit = std::max(limit, length + 1);
+            }
+        }
+    }
+    for (auto& edge : edges) {
+        edge.weight = 2 * (limit - edge.weight);
+    }
+
+    auto mate = WeightedMatching(n, std::move(edges)).Solve();
+    for (int v = 0; v < n; v++) {
+        if (mate[v] == -1) {
+            unmatched.push_back(cluster[v]);
+        } else if (v < mate[v]) {
+            int a = cluster[v];
+            int b = cluster[mate[v]];
+            matching.push_back({a, b, EuclideanDistance(points[a], points[b])});
+        }
+    }
+}
+
+// Splits vertices by coordinate medians into even-sized clusters of at most MATCHING_CLUSTER_SIZE
+void SplitIntoClusters(std::vector<int> vertices, const std::vector<Point>& points,
+                       std::vector<std::vector<int>>& clusters) {
+    if ((int)vertices.size() <= MATCHING_CLUSTER_SIZE) {
+        clusters.push_back(std::move(vertices));
+        return;
+    }
+
+    double minX = std::numeric_limits<double>::max();
+    double maxX = std::numeric_limits<double>::lowest();
+    double minY = minX;
+    double maxY = maxX;
+    for (int v : vertices) {
+        minX = std::min(minX, points[v].x);
+        maxX = std::max(maxX, points[v].x);
+        minY = std::min(minY, points[v].y);
+        maxY = std::max(maxY, points[v].y);
+    }
+
+    bool splitByX = maxX - minX >= maxY - minY;
+    int middle = vertices.size() / 2 / 2 * 2;
+    std::nth_element(vertices.begin(), vertices.begin() + middle, vertices.end(), [&](int a, int b) {
+        return splitByX ? points[a].x < points[b].x : points[a].y < points[b].y;
+    });
+
+    SplitIntoClusters(std::vector<int>(vertices.begin(), vertices.begin() + middle), points, clusters);
+    SplitIntoClusters(std::vector<int>(vertices.begin() + middle, vertices.end()), points, clusters);
+}
+
+// Blossom matching of the odd vertices. The exact algorithm is run independently (and in parallel)
+// on spatial clusters, leftovers are paired greedily
+std::vector<Edge> MinimumWeightMatching(const std::vector<int>& oddVertices, const std::vector<Point>& points,
+                                       int threadCount) {
+    std::vector<std::vector<int>> clusters;
+    SplitIntoClusters(oddVertices, points, clusters);
+
+    threadCount = std::max(1, std::min<int>(threadCount, clusters.size()));
+    std::vector<std::vector<Edge>> threadMatching(threadCount);
+    std::vector<std::vector<int>> threadUnmatched(threadCount);
+    std::atomic<int> nextCluster = 0;
+    auto worker = [&](int t) {
+        for (int i = nextCluster++; i < (int)clusters.size(); i = nextCluster++) {
+            MatchCluster(clusters[i], points, threadMatching[t], threadUnmatched[t]);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threadCount; t++) {
+        workers.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    std::vector<Edge> matching;
+    std::vector<int> unmatched;
+    for (int t = 0; t < threadCount; t++) {
+        matching.insert(matching.end(), threadMatching[t].begin(), threadMatching[t].end());
+        unmatched.insert(unmatched.end(), threadUnmatched[t].begin(), threadUnmatched[t].end());
+    }
+
+    if (!unmatched.empty()) {
+        auto completion = GreedyMinimumMatching(unmatched, points);
+        matching.insert(matching.end(), completion.begin(), completion.end());
+    }
+
+    return matching;
+}
+
+std::vector<int> ChristofidesAlgorithm(const std::vector<Point>& points, int threadCount, bool smartShortcutting) {
+    std::cout << "Running base algorithm...\n";
+
+    auto mst = BuildMST(points, threadCount);
+
+    auto oddVertices = FindOddDegreeVertices(mst, points.size());
+    auto matching = MinimumWeightMatching(oddVertices, points, threadCount);
+
+    auto edges = std::move(mst);
+    edges.insert(edges.end(), matching.begin(), matching.end());
+    auto graph = BuildCsrGraph(edges, points.size());
+    auto eulerCycle = FindEulerianCycle(edges, graph, 0);
+    auto hamCycle = smartShortcutting ? SmartEulerianToHamiltonian(eulerCycle, points)
+                                      : EulerianToHamiltonian(eulerCycle, points.size());
+
+    return hamCycle;
+}
+
+// Position of (x, y) along the Hilbert curve filling a 2^order x 2^order grid
+long long HilbertIndex(int order, long long x, long long y) {
+    long long index = 0;
+    for (long long side = 1LL << (order - 1); side > 0; side /= 2) {
+        int rx = (x & side) > 0;
+        int ry = (y & side) > 0;
+        index += side * side * ((3 * rx) ^ ry);
+
+        // Rotate the quadrant so that the curve continues where it entered
+        if (ry == 0) {
+            if (rx == 1) {
+                x = side - 1 - x;
+                y = side - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+
+    return index;
+}
+
+// Visits cities in the order of a space-filling curve
+std::vector<int> SpaceFillingCurveAlgorithm(const std::vector<Point>& points) {
+    std::cout << "Running space-filling curve algorithm...\n";
+
+    double minX = std::numeric_limits<double>::max();
+    double minY = minX;
+    double size = 0.0;
+    for (const auto& point : points) {
+        minX = std::min(minX, point.x);
+        minY = std::min(minY, point.y);
+    }
+    for (const auto& point : points) {
+        size = std::max({size, point.x - minX, point.y - minY});
+    }
+
+    const int order = 20;
+    double scale = size > 0 ? ((1 << order) - 1) / size : 0.0;
+    std::vector<std::pair<long long, int>> keys;
+    for (int v = 0; v < (int)points.size(); v++) {
+        long long x = (points[v].x - minX) * scale;
+        long long y = (points[v].y - minY) * scale;
+        keys.push_back({HilbertIndex(order, x, y), v});
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<int> cycle;
+    for (const auto& [key, v] : keys) {
+        cycle.push_back(v);
+    }
+
+    return cycle;
+}
+
+// Always goes to the nearest unvisited city, found by a k-d tree query that skips visited subtrees
+std::vector<int> NearestNeighborAlgorithm(const std::vector<Point>& points) {
+    std::cout << "Running nearest neighbor algorithm...\n";
+
+    std::vector<int> cycle;
+    if (points.empty()) {
+        return cycle;
+    }
+
+    KdTree tree(points);
+    std::vector<int> visited(points.size(), 0);
+    tree.UpdateColors(visited);
+
+    int v = 0;
+    while (v != -1) {
+        cycle.push_back(v);
+        visited[v] = 1;
+        tree.UpdateColor(v, visited);
+
+        double bestSq = std::numeric_limits<double>::max();
+        v = tree.NearestOfOtherColor(v, visited, bestSq);
+    }
+
+    return cycle;
+}
+
+// Greedy matching on tour fragments: forced edges are taken first, then candidate edges from shortest
+// while they keep degrees at most 2 and close no cycle. Remaining fragments are joined end to end in
+// Boruvka-like rounds, each endpoint looking up the nearest endpoint of another fragment in a k-d tree
+std::vector<int> BuildCycleFromFragments(const std::vector<Point>& points, const std::vector<Edge>& forcedEdges,
+                                         std::vector<Edge> candidates) {
+    int n = points.size();
+    if (n < 3) {
+        std::vector<int> cycle(n);
+        std::iota(cycle.begin(), cycle.end(), 0);
+        return cycle;
+    }
+
+    std::vector<std::array<int, 2>> links(n, {-1, -1});
+    DSU fragments(n);
+    int edgesAdded = 0;
+    auto tryAdd = [&](int u, int v) {
+        if (links[u][1] != -1 || links[v][1] != -1 || !fragments.Unite(u, v)) {
+            return;
+        }
+
+        links[u][links[u][0] == -1 ? 0 : 1] = v;
+        links[v][links[v][0] == -1 ? 0 : 1] = u;
+        edgesAdded++;
+    };
+
+    for (const auto& edge : forcedEdges) {
+        tryAdd(edge.u, edge.v);
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    for (const auto& edge : candidates) {
+        tryAdd(edge.u, edge.v);
+    }
+
+    while (edgesAdded + 1 < n) {
+        std::vector<int> endpoints;
+        for (int v = 0; v < n; v++) {
+            if (links[v][1] == -1) {
+                endpoints.push_back(v);
+            }
+        }
+
+        std::vector<Point> endpointPoints;
+        std::vector<int> colors;
+        for (int v : endpoints) {
+            endpointPoints.push_back(points[v]);
+            colors.push_back(fragments.GetParent(v));
+        }
+
+        KdTree tree(endpointPoints);
+        tree.UpdateColors(colors);
+        std::vector<Edge> joins;
+        for (int i = 0; i < (int)endpoints.size(); i++) {
+            double bestSq = std::numeric_limits<double>::max();
+            int j = tree.NearestOfOtherColor(i, colors, bestSq);
+            if (j != -1) {
+                joins.push_back({endpoints[i], endpoints[j], std::sqrt(bestSq)});
+            }
+        }
+
+        std::sort(joins.begin(), joins.end());
+        for (const auto& edge : joins) {
+            tryAdd(edge.u, edge.v);
+        }
+    }
+
+    // Walk the Hamiltonian path from one of its ends
+    int start = 0;
+    while (links[start][1] != -1) {
+        start++;
+    }
+
+    std::vector<int> cycle;
+    for (int prev = -1, v = start; v != -1;) {
+        cycle.push_back(v);
+        int next = (links[v][0] != prev ? links[v][0] : links[v][1]);
+        prev = v;
+        v = next;
+    }
+
+    return cycle;
+}
+
+std::vector<int> GreedyEdgeAlgorithm(const std::vector<Point>& points, int threadCount) {
+    std::cout << "Running greedy edge algorithm...\n";
+
+    auto neighbors = BuildNeighborLists(points, NEIGHBOR_LIST_SIZE, threadCount);
+    std::vector<Edge> candidates;
+    for (int v = 0; v < (int)points.size(); v++) {
+        for (int u : neighbors[v]) {
+            if (v < u) {
+                candidates.push_back({v, u, EuclideanDistance(points[v], points[u])});
+            }
+        }
+    }
+
+    return BuildCycleFromFragments(points, {}, std::move(candidates));
+}
+
+enum class Constructor {
+    Christofides,
+    GreedyEdge,
+    NearestNeighbor,
+    SpaceFillingCurve,
+};
+
+enum class Optimizer {
+    TwoOpt,
+    LinKernighan,
+};
+
+enum class Candidates {
+    NearestNeighbors,
+    AlphaNearness,
+};
+
+struct Options {
+    Constructor constructor = Constructor::Christofides;
+    bool smartShortcutting = true;
+    Optimizer optimizer = Optimizer::TwoOpt;
+    Candidates candidates = Candidates::NearestNeighbors;
+    bool parallel = false;
+    bool warmStart = false;
+    std::string previousInput;
+    double timeLimit = 0.0;
+    int populationSize = POPULATION_SIZE;
+    unsigned seed = 0;
+    int threadCount = std::max(1u, std::thread::hardware_concurrency());
+};
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--constructor=christofides") {
+            options.constructor = Constructor::Christofides;
+        } else if (arg == "--constructor=greedy") {
+            options.constructor = Constructor::GreedyEdge;
+        } else if (arg == "--constructor=nearest") {
+            options.constructor = Constructor::NearestNeighbor;
+        } else if (arg == "--constructor=hilbert") {
+            options.constructor = Constructor::SpaceFillingCurve;
+        } else if (arg == "--shortcut=first") {
+            options.smartShortcutting = false;
+        } else if (arg == "--shortcut=smart") {
+            options.smartShortcutting = true;
+        } else if (arg == "--optimizer=2opt") {
+            options.optimizer = Optimizer::TwoOpt;
+        } else if (arg == "--optimizer=lk") {
+            options.optimizer = Optimizer::LinKernighan;
+        } else if (arg == "--candidates=knn") {
+            options.candidates = Candidates::NearestNeighbors;
+        } else if (arg == "--candidates=alpha") {
+            options.candidates = Candidates::AlphaNearness;
+        } else if (arg == "--parallel") {
+            options.parallel = true;
+        } else if (arg == "--warm-start") {
+            options.warmStart = true;
+        } else if (arg.rfind("--previous-input=", 0) == 0) {
+            options.previousInput = arg.substr(std::string("--previous-input=").size());
+        } else if (arg.rfind("--time-limit=", 0) == 0) {
+            options.timeLimit = std::atof(arg.c_str() + std::string("--time-limit=").size());
+        } else if (arg.rfind("--population=", 0) == 0) {
+            options.populationSize = std::max(2, std::atoi(arg.c_str() + std::string("--population=").size()));
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            options.seed = std::strtoul(arg.c_str() + std::string("--seed=").size(), nullptr, 10);
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            options.threadCount = std::max(1, std::atoi(arg.c_str() + std::string("--threads=").size()));
+        } else {
+            std::cerr << "Unknown option: " << arg << '\n'
+                      << "Usage: tsp [--constructor=christofides|greedy|nearest|hilbert] [--shortcut=first|smart] [--optimizer=2opt|lk] [--candidates=knn|alpha] [--parallel]\n"
+                      << "           [--warm-start [--previous-input=FILE]] [--time-limit=SECONDS [--population=N]]\n"
+                      << "           [--seed=N] [--threads=N]\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::vector<int> BuildCycle(const std::vector<Point>& points, const Options& options) {
+    switch (options.constructor) {
+        case Constructor::GreedyEdge:
+            return GreedyEdgeAlgorithm(points, options.threadCount);
+        case Constructor::NearestNeighbor:
+            return NearestNeighborAlgorithm(points);
+        case Constructor::SpaceFillingCurve:
+            return SpaceFillingCurveAlgorithm(points);
+        default:
+            return ChristofidesAlgorithm(points, options.threadCount, options.smartShortcutting);
+    }
+}
+
+void RunLocalSearch(std::vector<int>& cycle, const std::vector<int>& activeCities, const CityCoordinates& coordinates,
+                    const std::vector<std::vector<int>>& neighbors, Optimizer optimizer,
+                    std::pair<int, int> fixedEdge = {-1, -1},
+                    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max()) {
+    if (optimizer == Optimizer::LinKernighan) {
+        LocalSearch<TwoLevelListTour> search(coordinates, neighbors, true);
+        search.SetFixedEdge(fixedEdge.first, fixedEdge.second);
+        search.SetDeadline(deadline);
+        search.Optimize(cycle, activeCities);
+    } else {
+        LocalSearch<ArrayTour> search(coordinates, neighbors);
+        search.SetFixedEdge(fixedEdge.first, fixedEdge.second);
+        search.SetDeadline(deadline);
+        search.Optimize(cycle, activeCities);
+    }
+}
+
+// Optimizes cycle[begin .. begin + length) (positions taken cyclically) as a path with fixed ends
+void OptimizeTourSegment(std::vector<int>& cycle, int begin, int length, const std::vector<Point>& points,
+                         Optimizer optimizer) {
+    int n = cycle.size();
+    std::vector<int> cities(length);
+    std::vector<Point> segmentPoints(length);
+    for (int i = 0; i < length; i++) {
+        cities[i] = cycle[(begin + i) % n];
+        segmentPoints[i] = points[cities[i]];
+    }
+
+    // The path is closed into a cycle by the edge between its ends, which is never removed
+    auto neighbors = BuildNeighborLists(segmentPoints, NEIGHBOR_LIST_SIZE, 1);
+    std::vector<int> path(length);
+    std::iota(path.begin(), path.end(), 0);
+    RunLocalSearch(path, path, CityCoordinates(segmentPoints), neighbors, optimizer, {0, length - 1});
+
+    std::rotate(path.begin(), std::find(path.begin(), path.end(), 0), path.end());
+    if (path.back() != length - 1) {
+        std::reverse(path.begin() + 1, path.end());
+    }
+
+    for (int i = 0; i < length; i++) {
+        cycle[(begin + i) % n] = cities[path[i]];
+    }
+}
+
+// Cuts the tour into contiguous segments that are optimized concurrently, segment boundaries
+// are shifted between rounds so that every part of the tour gets away from a boundary
+void PartitionedOptimization(std::vector<int>& cycle, const std::vector<Point>& points,
+                             const CityCoordinates& coordinates, const Options& options) {
+    int n = cycle.size();
+    int segmentSize = std::max(PARALLEL_MIN_SEGMENT_SIZE, n / (options.threadCount * PARALLEL_SEGMENTS_PER_THREAD));
+    int segmentCount = n / segmentSize;
+    if (segmentCount < 2) {
+        return;
+    }
+
+    ThreadPool pool(options.threadCount);
+    for (int round = 0; round < PARALLEL_ROUNDS; round++) {
+        int offset = (long long)segmentSize * round / PARALLEL_ROUNDS;
+        for (int i = 0; i < segmentCount; i++) {
+            int begin = offset + i * segmentSize;
+            int length = (i + 1 == segmentCount ? n - i * segmentSize : segmentSize);
+            pool.Submit([&cycle, &points, &options, begin, length] {
+                OptimizeTourSegment(cycle, begin, length, points, options.optimizer);
+            });
+        }
+        pool.Wait();
+
+        std::cout << "Parallel round " << round + 1 << ": " << coordinates.CycleLength(cycle) << '\n';
+    }
+}
+
+// Candidate lists for local search: nearest neighbors, or alpha-nearest ones with --candidates=alpha. The latter
+// also gives the Held-Karp lower bound, upperBound is the length of any tour. The bound takes O(n^2) time
+std::vector<std::vector<int>> BuildCandidateLists(const std::vector<Point>& points, double upperBound,
+                                                  const Options& options, double& lowerBound) {
+    if (options.candidates == Candidates::AlphaNearness) {
+        std::cout << "Computing Held-Karp lower bound...\n";
+        HeldKarpBound bound(points, options.threadCount);
+        lowerBound = bound.Compute(upperBound);
+        std::cout << "Held-Karp lower bound: " << lowerBound << '\n';
+        return bound.AlphaNearestNeighbors(ALPHA_NEIGHBOR_LIST_SIZE);
+    }
+
+    return BuildNeighborLists(points, NEIGHBOR_LIST_SIZE, options.threadCount);
+}
+
+void OptimizeCycle(std::vector<int>& cycle, const std::vector<Point>& points, const CityCoordinates& coordinates,
+                   const std::vector<std::vector<int>>& neighbors, const Options& options) {
+    if (options.parallel) {
+        std::cout << "Optimizing " << options.threadCount << " tour segments at a time...\n";
+        PartitionedOptimization(cycle, points, coordinates, options);
+    }
+
+    if (options.optimizer == Optimizer::LinKernighan) {
+        std::cout << "Optimizing with Lin-Kernighan and Or-opt...\n";
+        RunLocalSearch(cycle, cycle, coordinates, neighbors, options.optimizer);
+        std::cout << "After Lin-Kernighan and Or-opt: " << coordinates.CycleLength(cycle) << '\n';
+    } else {
+        std::cout << "Optimizing with 2-opt and Or-opt...\n";
+        RunLocalSearch(cycle, cycle, coordinates, neighbors, options.optimizer);
+        std::cout << "After 2-opt and Or-opt: " << coordinates.CycleLength(cycle) << '\n';
+    }
+}
+
+// Local double bridge kicks: A B C D -> A C B D with all cut points inside a short window of the tour.
+// Returns the cities whose tour edges were changed
+std::vector<int> PerturbCycle(std::vector<int>& cycle, std::mt19937& random) {
+    int n = cycle.size();
+    std::vector<int> kicked;
+    if (n < 2 * PERTURBATION_WINDOW) {
+        return kicked;
+    }
+
+    int kicks = std::max(1, n / PERTURBATION_CITIES_PER_KICK);
+    for (int i = 0; i < kicks; i++) {
+        int begin = random() % (n - PERTURBATION_WINDOW);
+        std::array<int, 3> cuts;
+        for (int& cut : cuts) {
+            cut = begin + 1 + random() % (PERTURBATION_WINDOW - 1);
+        }
+        std::sort(cuts.begin(), cuts.end());
+        for (int cut : cuts) {
+            kicked.push_back(cycle[cut - 1]);
+            kicked.push_back(cycle[cut]);
+        }
+        std::rotate(cycle.begin() + cuts[0], cycle.begin() + cuts[1], cycle.begin() + cuts[2]);
+    }
+
+    return kicked;
+}
+
+// Partition crossover: cities touched by edges that only one parent has split into connected components. If both
+// parents visit a component in a single contiguous run with the same two ends, either run can be taken independently
+// of the other components, so the child takes the shorter one everywhere and keeps the first parent elsewhere.
+// The child is never longer than the first parent, local search then restarts from the replaced runs
+std::vector<int> PartitionCrossover(const std::vector<int>& first, const std::vector<int>& second,
+                                    const CityCoordinates& coordinates, const std::vector<std::vector<int>>& neighbors,
+                                    Optimizer optimizer, std::chrono::steady_clock::time_point deadline) {
+    int n = first.size();
+    std::vector<int> nextInFirst(n);
+    std::vector<int> prevInFirst(n);
+    std::vector<int> nextInSecond(n);
+    std::vector<int> prevInSecond(n);
+    for (int i = 0; i < n; i++) {
+        nextInFirst[first[i]] = first[(i + 1) % n];
+        prevInFirst[first[(i + 1) % n]] = first[i];
+        nextInSecond[second[i]] = second[(i + 1) % n];
+        prevInSecond[second[(i + 1) % n]] = second[i];
+    }
+
+    DSU dsu(n);
+    std::vector<bool> touched(n, false);
+    for (int v = 0; v < n; v++) {
+        int u = nextInFirst[v];
+        if (nextInSecond[v] != u && prevInSecond[v] != u) {
+            dsu.Unite(v, u);
+            touched[v] = touched[u] = true;
+        }
+
+        u = nextInSecond[v];
+        if (nextInFirst[v] != u && prevInFirst[v] != u) {
+            dsu.Unite(v, u);
+            touched[v] = touched[u] = true;
+        }
+    }
+
+    std::vector<int> component(n, -1);
+    for (int v = 0; v < n; v++) {
+        if (touched[v]) {
+            component[v] = dsu.GetParent(v);
+        }
+    }
+
+    // Runs of every component along a parent: count, first and last position, length of the edges inside
+    struct Run {
+        int count = 0;
+        int begin = -1;
+        int end = -1;
+        double length = 0.0;
+    };
+    auto findRuns = [&](const std::vector<int>& tour) {
+        std::vector<Run> runs(n);
+        for (int i = 0; i < n; i++) {
+            int c = component[tour[i]];
+            if (c == -1) {
+                continue;
+            }
+
+            int prev = tour[(i + n - 1) % n];
+            int next = tour[(i + 1) % n];
+            if (component[prev] != c) {
+                runs[c].count++;
+                runs[c].begin = i;
+            }
+            if (component[next] != c) {
+                runs[c].end = i;
+            } else {
+                runs[c].length += coordinates.Distance(tour[i], next);
+            }
+        }
+
+        return runs;
+    };
+    auto firstRuns = findRuns(first);
+    auto secondRuns = findRuns(second);
+
+    std::vector<bool> replaced(n, false);
+    for (int c = 0; c < n; c++) {
+        const auto& a = firstRuns[c];
+        const auto& b = secondRuns[c];
+        if (a.count != 1 || b.count != 1 || b.length >= a.length - EPS) {
+            continue;
+        }
+
+        int firstBegin = first[a.begin];
+        int firstEnd = first[a.end];
+        int secondBegin = second[b.begin];
+        int secondEnd = second[b.end];
+        if ((firstBegin == secondBegin && firstEnd == secondEnd) || (firstBegin == secondEnd && firstEnd == secondBegin)) {
+            replaced[c] = true;
+        }
+    }
+
+    // The walk starts at a run start if the first city belongs to a replaced run, so runs never wrap around
+    int offset = 0;
+    if (component[first[0]] != -1 && replaced[component[first[0]]]) {
+        offset = firstRuns[component[first[0]]].begin;
+    }
+
+    std::vector<int> child;
+    std::vector<int> activeCities;
+    for (int k = 0; k < n; k++) {
+        int i = (offset + k) % n;
+        int v = first[i];
+        int c = component[v];
+        if (c == -1 || !replaced[c]) {
+            child.push_back(v);
+            continue;
+        }
+        if (i != firstRuns[c].begin) {
+            continue;
+        }
+
+        const auto& run = secondRuns[c];
+        int length = (run.end - run.begin + n) % n + 1;
+        bool forward = second[run.begin] == v;
+        for (int j = 0; j < length; j++) {
+            int u = forward ? second[(run.begin + j) % n] : second[(run.end - j + n) % n];
+            child.push_back(u);
+            activeCities.push_back(u);
+        }
+    }
+
+    if (activeCities.empty()) {
+        return first;
+    }
+
+    RunLocalSearch(child, activeCities, coordinates, neighbors, optimizer, {-1, -1}, deadline);
+    return child;
+}
+
+// Steady-state genetic search within the time limit: every generation crosses one random pair of tours per thread,
+// a child replaces the worst tour of the population if it is shorter and not a duplicate. Local search stops at the
+// deadline, so a generation in progress can't overrun the limit
+std::vector<int> PopulationSearch(const std::vector<int>& cycle, const std::vector<Point>& points,
+                                  const CityCoordinates& coordinates, const std::vector<std::vector<int>>& neighbors,
+                                  const Options& options) {
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&] {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                std::chrono::duration<double>(options.timeLimit));
+
+    std::cout << "Building population of " << options.populationSize << " tours...\n";
+    std::mt19937 random(options.seed);
+
+    // Members are different local optima: tours of the other constructors first (while less than half of the time
+    // is spent), then copies of the current tour kicked with independent random moves
+    std::vector<Constructor> constructors;
+    for (auto constructor : {Constructor::GreedyEdge, Constructor::Christofides, Constructor::SpaceFillingCurve,
+                             Constructor::NearestNeighbor}) {
+        if (constructor != options.constructor) {
+            constructors.push_back(constructor);
+        }
+    }
+
+    std::vector<std::vector<int>> population(options.populationSize, cycle);
+    std::vector<std::vector<int>> activeCities(options.populationSize);
+    for (int i = 1; i < options.populationSize; i++) {
+        if (i - 1 < (int)constructors.size() && elapsed() < options.timeLimit / 2) {
+            Options memberOptions = options;
+            memberOptions.constructor = constructors[i - 1];
+            population[i] = BuildCycle(points, memberOptions);
+            activeCities[i] = population[i];
+        } else {
+            activeCities[i] = PerturbCycle(population[i], random);
+        }
+    }
+
+    ThreadPool pool(options.threadCount);
+    for (int i = 1; i < options.populationSize; i++) {
+        pool.Submit([&, i] {
+            RunLocalSearch(population[i], activeCities[i], coordinates, neighbors, options.optimizer, {-1, -1},
+                           deadline);
+        });
+    }
+    pool.Wait();
+
+    std::vector<double> lengths;
+    for (const auto& member : population) {
+        lengths.push_back(coordinates.CycleLength(member));
+    }
+    double best = *std::min_element(lengths.begin(), lengths.end());
+    std::cout << "Population ready in " << elapsed() << "s, best: " << best << '\n';
+
+    int generation = 0;
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::vector<std::vector<int>> children(options.threadCount);
+        for (auto& child : children) {
+            int a = random() % population.size();
+            int b = (a + 1 + random() % (population.size() - 1)) % population.size();
+            if (lengths[b] < lengths[a]) {
+                std::swap(a, b);
+            }
+            pool.Submit([&, a, b] {
+                child = PartitionCrossover(population[a], population[b], coordinates, neighbors, options.optimizer,
+                                           deadline);
+            });
+        }
+        pool.Wait();
+        generation++;
+
+        bool accepted = false;
+        for (auto& child : children) {
+            double length = coordinates.CycleLength(child);
+            int worst = std::max_element(lengths.begin(), lengths.end()) - lengths.begin();
+            bool duplicate = std::any_of(lengths.begin(), lengths.end(), [&](double other) {
+                return std::abs(other - length) < EPS;
+            });
+            if (length < lengths[worst] && !duplicate) {
+                population[worst] = std::move(child);
+                lengths[worst] = length;
+                accepted = true;
+            }
+        }
+
+        // The population has converged: the worst tour is replaced with a kicked copy of the best one
+        if (!accepted) {
+            int bestMember = std::min_element(lengths.begin(), lengths.end()) - lengths.begin();
+            int worst = bestMember == 0 ? 1 : 0;
+            for (int i = 0; i < (int)lengths.size(); i++) {
+                if (i != bestMember && lengths[i] > lengths[worst]) {
+                    worst = i;
+                }
+            }
+
+            population[worst] = population[bestMember];
+            auto kickedCities = PerturbCycle(population[worst], random);
+            RunLocalSearch(population[worst], kickedCities, coordinates, neighbors, options.optimizer, {-1, -1},
+                           deadline);
+            lengths[worst] = coordinates.CycleLength(population[worst]);
+        }
+
+        double generationBest = *std::min_element(lengths.begin(), lengths.end());
+        if (generationBest < best) {
+            best = generationBest;
+            std::cout << "Generation " << generation << " (" << elapsed() << "s): " << best << '\n';
+        }
+    }
+
+    std::cout << "Population search: " << generation << " generations, best: " << best << '\n';
+    return population[std::min_element(lengths.begin(), lengths.end()) - lengths.begin()];
+}
+
+// Reads "[id] [x] [y]" lines, points[i] gets ids[i]
+std::vector<Point> ReadPoints(const std::string& path, std::vector<int>& ids) {
+    std::ifstream fin(path);
+    std::vector<Point> points;
+
+    int id = 0;
+    double x = 0;
+    double y = 0;
+    while (fin >> id >> x >> y) {
+        ids.push_back(id);
+        points.push_back({x, y});
+    }
+
+    return points;
+}
+
+// Turns the tour from the previous run (output.txt) into a cycle over the current points: cities that were removed
+// (or moved, if the previous input is known) are cut out, new and moved ones are inserted at the cheapest position
+// next to their nearest tour cities. Cities around every change are collected into touched. Returns an empty cycle
+// if less than 3 cities of the previous tour are left
+std::vector<int> WarmStartCycle(const std::vector<Point>& points, const std::vector<int>& ids, const Options& options,
+                                std::vector<int>& touched) {
+    int n = points.size();
+    std::unordered_map<int, int> indexById;
+    for (int v = 0; v < n; v++) {
+        indexById[ids[v]] = v;
+    }
+
+    std::vector<bool> moved(n, false);
+    if (!options.previousInput.empty()) {
+        std::vector<int> previousIds;
+        auto previousPoints = ReadPoints(options.previousInput, previousIds);
+        for (int i = 0; i < (int)previousPoints.size(); i++) {
+            auto it = indexById.find(previousIds[i]);
+            if (it != indexById.end() && EuclideanDistance(points[it->second], previousPoints[i]) > EPS) {
+                moved[it->second] = true;
+            }
+        }
+    }
+
+    std::ifstream fin("output.txt");
+    std::vector<int> kept;
+    std::vector<bool> inTour(n, false);
+    bool cut = false;
+    bool leadingCut = false;
+    int id = 0;
+    while (fin >> id) {
+        auto it = indexById.find(id);
+        if (it == indexById.end() || moved[it->second] || inTour[it->second]) {
+            cut = true;
+            continue;
+        }
+
+        int v = it->second;
+        if (cut && kept.empty()) {
+            leadingCut = true;
+        } else if (cut) {
+            touched.push_back(kept.back());
+            touched.push_back(v);
+        }
+        cut = false;
+        kept.push_back(v);
+        inTour[v] = true;
+    }
+    // Cities cut at either end of the file are replaced by the wrap-around edge
+    if ((cut || leadingCut) && !kept.empty()) {
+        touched.push_back(kept.back());
+        touched.push_back(kept.front());
+    }
+
+    if (kept.size() < 3) {
+        return {};
+    }
+
+    std::vector<int> next(n, -1);
+    std::vector<int> prev(n, -1);
+    for (int i = 0; i < (int)kept.size(); i++) {
+        next[kept[i]] = kept[(i + 1) % kept.size()];
+        prev[next[kept[i]]] = kept[i];
+    }
+
+    // Tree order inserts nearby cities one after another
+    KdTree tree(points);
+    int inserted = 0;
+    for (int c : tree.GetOrder()) {
+        if (inTour[c]) {
+            continue;
+        }
+
+        double bestDelta = std::numeric_limits<double>::max();
+        int bestFrom = -1;
+        for (int k = INSERTION_NEIGHBOR_COUNT; bestFrom == -1; k *= 2) {
+            for (int u : tree.NearestNeighbors(c, std::min(k, n - 1))) {
+                if (!inTour[u]) {
+                    continue;
+                }
+
+                for (int from : {prev[u], u}) {
+                    int to = next[from];
+                    double delta = EuclideanDistance(points[from], points[c]) + EuclideanDistance(points[c], points[to]) -
+                                   EuclideanDistance(points[from], points[to]);
+                    if (delta < bestDelta) {
+                        bestDelta = delta;
+                        bestFrom = from;
+                    }
+                }
+            }
+        }
+
+        next[c] = next[bestFrom];
+        prev[c] = bestFrom;
+        prev[next[c]] = c;
+        next[bestFrom] = c;
+        inTour[c] = true;
+        touched.push_back(c);
+        inserted++;
+    }
+
+    std::cout << "Previous tour: " << kept.size() << " cities kept, " << inserted << " inserted\n";
+
+    std::vector<int> cycle;
+    int v = kept[0];
+    do {
+        cycle.push_back(v);
+        v = next[v];
+    } while (v != kept[0]);
+
+    return cycle;
+}
+
+// Local search that starts only from the touched cities and their tour neighbors
+void ReoptimizeCycle(std::vector<int>& cycle, const std::vector<int>& touched, const CityCoordinates& coordinates,
+                     const std::vector<std::vector<int>>& neighbors, const Options& options) {
+    int n = cycle.size();
+    std::vector<int> position(n);
+    for (int i = 0; i < n; i++) {
+        position[cycle[i]] = i;
+    }
+
+    std::vector<int> activeCities;
+    for (int v : touched) {
+        activeCities.push_back(cycle[(position[v] + n - 1) % n]);
+        activeCities.push_back(v);
+        activeCities.push_back(cycle[(position[v] + 1) % n]);
+    }
+
+    std::cout << "Re-optimizing around " << touched.size() << " touched cities...\n";
+    RunLocalSearch(cycle, activeCities, coordinates, neighbors, options.optimizer);
+    std::cout << "After re-optimization: " << coordinates.CycleLength(cycle) << '\n';
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::vector<int> ids;
+    auto points = ReadPoints("input.txt", ids);
+    std::cout << "Graph: " << points.size() << " vertices\n\n";
+    CityCoordinates coordinates(points);
+
+    std::vector<int> cycle;
+    std::vector<int> touched;
+    if (options.warmStart) {
+        cycle = WarmStartCycle(points, ids, options, touched);
+        if (cycle.empty()) {
+            std::cout << "Previous tour is unusable, building from scratch...\n";
+        }
+    }
+
+    bool warmStarted = !cycle.empty();
+    if (!warmStarted) {
+        cycle = BuildCycle(points, options);
+    }
+    std::cout << "Initial Hamiltonian cycle length: " << coordinates.CycleLength(cycle) << '\n';
+
+    double lowerBound = 0.0;
+    auto neighbors = BuildCandidateLists(points, coordinates.CycleLength(cycle), options, lowerBound);
+    if (warmStarted) {
+        ReoptimizeCycle(cycle, touched, coordinates, neighbors, options);
+    } else {
+        OptimizeCycle(cycle, points, coordinates, neighbors, options);
+    }
+
+    if (options.timeLimit > 0) {
+        cycle = PopulationSearch(cycle, points, coordinates, neighbors, options);
+    }
+
+    if (lowerBound > 0) {
+        double gap = (coordinates.CycleLength(cycle) / lowerBound - 1) * 100;
+        std::cout << "Gap to the lower bound: " << gap << "%\n";
+    }
 
     std::ofstream fout("output.txt");
     for (int v : cycle) {
-        fout << v + 1 << ' ';
+        fout << ids[v] << ' ';
     }
     fout << '\n';
     fout.close();
@@ -2,26 +2,36 @@
 #include <vector>
 #include <iostream>
 #include <unordered_set>
+#include <unordered_map>
+#include <thread>
+#include <string>
 
-struct Point {
-    int id;
-    double x, y;
-};
+#include "geometry.h"
+#include "held_karp.h"
 
-double EuclideanDistance(const Point& a, const Point& b) {
-    double dx = a.x - b.x;
-    double dy = a.y - b.y;
-    return std::sqrt(dx * dx + dy * dy);
-}
+int main(int argc, char** argv) {
+    // The bound ends with an O(n^2) Prim, so the check itself stays linear unless it is asked for
+    bool computeBound = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--lower-bound") {
+            computeBound = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << '\n'
+                      << "Usage: verify [--lower-bound]\n";
+            return 1;
+        }
+    }
 
-int main() {
     std::ifstream graphFile("input.txt");
     std::vector<Point> points;
+    std::unordered_map<int, int> indexById;
     int v = 0;
     double x = 0.0;
     double y = 0.0;
     while (graphFile >> v >> x >> y) {
-        points.push_back({v, x, y});
+        indexById[v] = points.size();
+        points.push_back({x, y});
     }
     graphFile.close();
 
@@ -51,24 +61,35 @@ int main() {
         visitedVertices.insert(vertex);
     }
 
-    for (int vertex : cycle) {
-        if (vertex < 1 || vertex > (int)points.size()) {
-            std::cout << "ERROR: Vertex " << vertex << " is out of range [1, " << points.size() << "]\n";
+    // The cycle lists input ids, which don't have to be 1..n
+    for (int& vertex : cycle) {
+        auto it = indexById.find(vertex);
+        if (it == indexById.end()) {
+            std::cout << "ERROR: Vertex " << vertex << " is not in the input\n";
             return 1;
         }
+        vertex = it->second;
     }
 
     std::cout << "Cycle is a valid Hamiltonian cycle\n";
 
     double totalLength = 0.0;
     for (int i = 0; i < (int)cycle.size(); i++) {
-        int currentVertex = cycle[i] - 1;
-        int nextVertex = cycle[(i + 1) % cycle.size()] - 1;
+        int currentVertex = cycle[i];
+        int nextVertex = cycle[(i + 1) % cycle.size()];
 
         double distance = EuclideanDistance(points[currentVertex], points[nextVertex]);
         totalLength += distance;
     }
 
     std::cout << "Cycle length: " << totalLength << '\n';
+    if (!computeBound) {
+        return 0;
+    }
+
+    int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    double lowerBound = HeldKarpBound(points, threadCount).Compute(totalLength);
+    std::cout << "Held-Karp lower bound: " << lowerBound << '\n';
+    std::cout << "Gap: " << (totalLength / lowerBound - 1) * 100 << "%\n";
     return 0;
 }
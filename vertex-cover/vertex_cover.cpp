@@ -2,29 +2,117 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <numeric>
+#include <cstdint>
+#include <string>
+#include <random>
+#include <chrono>
+#include <limits>
+#include <deque>
+#include <mutex>
+#include <thread>
 
-const int OPTIMIZE_MAX_ITERATIONS = 10;
+const double COVER_WRITE_INTERVAL = 1.0;
+const size_t EXACT_MAX_VERTICES = 200;
+const long long EXACT_NODE_LIMIT = 100000;
 
-std::vector<bool> EdgeBasedApproximation(const std::vector<std::pair<int, int>>& edges, int vertexCount) {
-    std::vector<bool> vertexCoverMask(vertexCount);
-    std::vector<bool> edgeCoverMask(edges.size());
+// Fixed-size set of vertices packed into 64-bit words
+class Bitset {
+public:
+    Bitset(int size = 0)
+        : Size_(size)
+        , Words_((size + 63) / 64, 0)
+    {
+    }
+
+    int GetSize() const {
+        return Size_;
+    }
+
+    bool operator[](int i) const {
+        return Words_[i >> 6] >> (i & 63) & 1;
+    }
+
+    void Set(int i) {
+        Words_[i >> 6] |= uint64_t(1) << (i & 63);
+    }
+
+    void Reset(int i) {
+        Words_[i >> 6] &= ~(uint64_t(1) << (i & 63));
+    }
+
+    int Count() const {
+        int count = 0;
+        for (uint64_t word : Words_) {
+            count += __builtin_popcountll(word);
+        }
+        return count;
+    }
+
+private:
+    int Size_;
+    std::vector<uint64_t> Words_;
+};
 
+// Adjacency lists of all vertices in flat arrays: the neighbors of v are Neighbors[Offset[v]..Offset[v + 1]),
+// EdgeIds holds the index of the edge in the input list for every entry. A loop is listed once
+struct CsrGraph {
+    std::vector<int> Offset;
+    std::vector<int> Neighbors;
+    std::vector<int> EdgeIds;
+
+    int GetVertexCount() const {
+        return Offset.size() - 1;
+    }
+
+    int GetDegree(int v) const {
+        return Offset[v + 1] - Offset[v];
+    }
+};
+
+CsrGraph BuildCsrGraph(const std::vector<std::pair<int, int>>& edges, int vertexCount) {
+    CsrGraph graph;
+    graph.Offset.assign(vertexCount + 1, 0);
+    for (auto [v, u] : edges) {
+        graph.Offset[v + 1]++;
+        if (u != v) {
+            graph.Offset[u + 1]++;
+        }
+    }
+    std::partial_sum(graph.Offset.begin(), graph.Offset.end(), graph.Offset.begin());
+
+    std::vector<int> filled(graph.Offset.begin(), graph.Offset.end() - 1);
+    graph.Neighbors.resize(graph.Offset.back());
+    graph.EdgeIds.resize(graph.Offset.back());
     for (int i = 0; i < (int)edges.size(); i++) {
-        if (!edgeCoverMask[i]) {
-            // Pick up edge in greedy way
-            auto [v , u] = edges[i];
-            if (!vertexCoverMask[v]) {
-                vertexCoverMask[v] = true;
-            }
-            if (!vertexCoverMask[u]) {
-                vertexCoverMask[u] = true;
-            }
+        auto [v, u] = edges[i];
+        graph.EdgeIds[filled[v]] = i;
+        graph.Neighbors[filled[v]++] = u;
+        if (u != v) {
+            graph.EdgeIds[filled[u]] = i;
+            graph.Neighbors[filled[u]++] = v;
+        }
+    }
 
-            for (int j = 0; j < (int)edges.size(); j++) {
-                auto [v2, u2] = edges[j];
-                if (v2 == v || u2 == v || v2 == u || u2 == u) {
-                    edgeCoverMask[j] = true;
-                }
+    return graph;
+}
+
+// Endpoints of a maximal matching, found greedily in one pass over the adjacency lists: O(V + E)
+Bitset EdgeBasedApproximation(const CsrGraph& graph) {
+    Bitset vertexCoverMask(graph.GetVertexCount());
+
+    for (int v = 0; v < graph.GetVertexCount(); v++) {
+        if (vertexCoverMask[v]) {
+            continue;
+        }
+
+        // Pick up the first uncovered edge of v in greedy way
+        for (int e = graph.Offset[v]; e < graph.Offset[v + 1]; e++) {
+            int u = graph.Neighbors[e];
+            if (!vertexCoverMask[u]) {
+                vertexCoverMask.Set(v);
+                vertexCoverMask.Set(u);
+                break;
             }
         }
     }
@@ -32,17 +120,11 @@ std::vector<bool> EdgeBasedApproximation(const std::vector<std::pair<int, int>>&
     return vertexCoverMask;
 }
 
-int GetCoverSize(const std::vector<bool>& vertexCoverMask) {
-    int size = 0;
-    for (int i = 0; i < (int)vertexCoverMask.size(); i++) {
-        if (vertexCoverMask[i]) {
-            size++;
-        }
-    }
-    return size;
+int GetCoverSize(const Bitset& vertexCoverMask) {
+    return vertexCoverMask.Count();
 }
 
-bool IsVertexCover(const std::vector<bool>& vertexCoverMask, const std::vector<std::pair<int, int>>& edges) {
+bool IsVertexCover(const Bitset& vertexCoverMask, const std::vector<std::pair<int, int>>& edges) {
     bool allEdgesCovered = true;
     for (const auto& edge : edges) {
         if (!vertexCoverMask[edge.first] && !vertexCoverMask[edge.second]) {
@@ -53,31 +135,1154 @@ bool IsVertexCover(const std::vector<bool>& vertexCoverMask, const std::vector<s
     return allEdgesCovered;
 }
 
-void RemoveRedundantVertices(std::vector<bool>& vertexCoverMask, const std::vector<std::pair<int, int>>& edges) {
-    bool improved = true;
-    for (int iteration = 0; iteration < OPTIMIZE_MAX_ITERATIONS && improved; iteration++) {
-        improved = false;
+// Cover together with, for every vertex, the total weight of its incident edges whose other endpoint is outside of
+// the cover. For a cover vertex these are the edges covered by it alone, so it can leave the cover exactly when the
+// counter is 0; for an outside vertex these are its uncovered edges. Adding or removing a vertex updates the counters
+// of its neighbors in O(deg). Every edge weighs 1 until SetWeights. A loop is always counted, it can only be covered
+// by its vertex
+class CoverCounters {
+public:
+    CoverCounters(const CsrGraph& graph, const Bitset& cover)
+        : Graph_(graph)
+        , Cover_(cover)
+        , Outside_(graph.GetVertexCount(), 0)
+    {
+        Recalculate();
+    }
+
+    const Bitset& GetCover() const {
+        return Cover_;
+    }
+
+    long long GetOutside(int v) const {
+        return Outside_[v];
+    }
+
+    bool IsRemovable(int v) const {
+        return Cover_[v] && Outside_[v] == 0;
+    }
+
+    int GetWeight(int e) const {
+        return Weights_.empty() ? 1 : Weights_[e];
+    }
+
+    // weights[e] for the edge with index e in the input list of the graph
+    void SetWeights(std::vector<int> weights) {
+        Weights_ = std::move(weights);
+        Recalculate();
+    }
+
+    // Changes the weight of edge e between v and u
+    void AddWeight(int e, int v, int u, int delta) {
+        Weights_[e] += delta;
+        if (u == v || !Cover_[u]) {
+            Outside_[v] += delta;
+        }
+        if (u != v && !Cover_[v]) {
+            Outside_[u] += delta;
+        }
+    }
+
+    void Add(int v) {
+        Cover_.Set(v);
+        for (int i = Graph_.Offset[v]; i < Graph_.Offset[v + 1]; i++) {
+            if (Graph_.Neighbors[i] != v) {
+                Outside_[Graph_.Neighbors[i]] -= GetWeight(Graph_.EdgeIds[i]);
+            }
+        }
+    }
+
+    void Remove(int v) {
+        Cover_.Reset(v);
+        for (int i = Graph_.Offset[v]; i < Graph_.Offset[v + 1]; i++) {
+            if (Graph_.Neighbors[i] != v) {
+                Outside_[Graph_.Neighbors[i]] += GetWeight(Graph_.EdgeIds[i]);
+            }
+        }
+    }
+
+private:
+    void Recalculate() {
+        std::fill(Outside_.begin(), Outside_.end(), 0);
+        for (int v = 0; v < Graph_.GetVertexCount(); v++) {
+            for (int i = Graph_.Offset[v]; i < Graph_.Offset[v + 1]; i++) {
+                int u = Graph_.Neighbors[i];
+                if (u == v || !Cover_[u]) {
+                    Outside_[v] += GetWeight(Graph_.EdgeIds[i]);
+                }
+            }
+        }
+    }
+
+    const CsrGraph& Graph_;
+    Bitset Cover_;
+    std::vector<long long> Outside_;
+    std::vector<int> Weights_;
+};
+
+// Drops cover vertices that no edge depends on alone, lowest degree first: such a vertex keeps few neighbors
+// in the cover. A removal only makes other vertices harder to remove, so one pass leaves a minimal cover. O(V + E)
+void RemoveRedundantVertices(Bitset& vertexCoverMask, const CsrGraph& graph) {
+    int n = graph.GetVertexCount();
+    std::vector<int> byDegree;
+    for (int v = 0; v < n; v++) {
+        if (vertexCoverMask[v]) {
+            byDegree.push_back(v);
+        }
+    }
+
+    // Counting sort by degree. Duplicate edges can push a degree past n - 1, so the buckets follow the largest one
+    int maxDegree = 0;
+    for (int v : byDegree) {
+        maxDegree = std::max(maxDegree, graph.GetDegree(v));
+    }
+    std::vector<int> start(maxDegree + 2, 0);
+    for (int v : byDegree) {
+        start[graph.GetDegree(v) + 1]++;
+    }
+    std::partial_sum(start.begin(), start.end(), start.begin());
+    std::vector<int> order(byDegree.size());
+    for (int v : byDegree) {
+        order[start[graph.GetDegree(v)]++] = v;
+    }
+
+    CoverCounters counters(graph, vertexCoverMask);
+    for (int v : order) {
+        if (counters.IsRemovable(v)) {
+            counters.Remove(v);
+        }
+    }
+
+    vertexCoverMask = counters.GetCover();
+}
+
+// Reductions shrinking the graph before solving, each keeping a minimum cover of the rest extendable to a minimum
+// cover of the whole graph:
+// - a vertex of degree 0 is never needed, the neighbor of a degree 1 vertex is taken, and so are both neighbors
+//   of a degree 2 vertex lying in a triangle;
+// - a degree 2 vertex v with non-adjacent neighbors u, w is folded: the three become one new vertex adjacent
+//   to N(u) and N(w), which stands for u and w when taken and for v otherwise;
+// - a vertex v dominating a neighbor u (N[u] lies within N[v]) is taken;
+// - Nemhauser-Trotter: a half-integral optimum of the LP relaxation is followed where it is 0 or 1. It comes from
+//   a minimum cover of the bipartite double cover (vertex v on both sides, u on the left joined with v on the right
+//   for every edge), i.e. from a maximum matching found by Hopcroft-Karp and Konig's theorem.
+// Decisions go to an undo stack, Lift replays it backwards to turn a cover of the kernel into one of the whole graph
+class Kernel {
+public:
+    Kernel(const std::vector<std::pair<int, int>>& edges, int vertexCount)
+        : OriginalCount_(vertexCount)
+        , Adjacency_(vertexCount)
+        , Alive_(vertexCount, true)
+        , Degree_(vertexCount, 0)
+    {
+        std::vector<int> loops;
+        for (auto [v, u] : edges) {
+            if (v == u) {
+                loops.push_back(v);
+            } else {
+                Adjacency_[v].push_back(u);
+                Adjacency_[u].push_back(v);
+            }
+        }
+        for (int v = 0; v < vertexCount; v++) {
+            auto& neighbors = Adjacency_[v];
+            std::sort(neighbors.begin(), neighbors.end());
+            neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+            Degree_[v] = neighbors.size();
+        }
+
+        // A loop can only be covered by its vertex
+        for (int v : loops) {
+            if (Alive_[v]) {
+                Take(v);
+            }
+        }
+    }
+
+    void Reduce() {
+        for (int v = 0; v < (int)Adjacency_.size(); v++) {
+            Queue_.push_back(v);
+        }
+
+        bool changed = true;
+        while (changed) {
+            int before = CountAlive();
+            ReduceLowDegrees();
+            ReduceDominated();
+            ReduceLowDegrees();
+            ReduceByLinearProgram();
+            changed = CountAlive() < before;
+        }
+
+        KernelIndex_.assign(Adjacency_.size(), -1);
+        KernelVertices_.clear();
+        for (int v = 0; v < (int)Adjacency_.size(); v++) {
+            if (Alive_[v]) {
+                KernelIndex_[v] = KernelVertices_.size();
+                KernelVertices_.push_back(v);
+            }
+        }
+
+        KernelEdges_.clear();
+        for (int v : KernelVertices_) {
+            for (int u : Neighbors(v)) {
+                if (KernelIndex_[u] > KernelIndex_[v]) {
+                    KernelEdges_.push_back({KernelIndex_[v], KernelIndex_[u]});
+                }
+            }
+        }
+    }
+
+    int GetVertexCount() const {
+        return KernelVertices_.size();
+    }
+
+    const std::vector<std::pair<int, int>>& GetEdges() const {
+        return KernelEdges_;
+    }
+
+    // Cover vertices decided by the reductions: a cover of the kernel lifts to a cover larger by exactly this
+    int GetTakenCount() const {
+        return TakenCount_;
+    }
+
+    Bitset Lift(const Bitset& kernelCover) const {
+        std::vector<bool> inCover(Adjacency_.size(), false);
+        for (int i = 0; i < (int)KernelVertices_.size(); i++) {
+            inCover[KernelVertices_[i]] = kernelCover[i];
+        }
+
+        for (int i = (int)Undo_.size() - 1; i >= 0; i--) {
+            const auto& step = Undo_[i];
+            if (step.folded == -1) {
+                inCover[step.v] = true;
+            } else if (inCover[step.folded]) {
+                inCover[step.u] = true;
+                inCover[step.w] = true;
+            } else {
+                inCover[step.v] = true;
+            }
+        }
 
-        for (int v = 0; v < (int)vertexCoverMask.size(); v++) {
-            if (!vertexCoverMask[v]) {
+        Bitset cover(OriginalCount_);
+        for (int v = 0; v < OriginalCount_; v++) {
+            if (inCover[v]) {
+                cover.Set(v);
+            }
+        }
+
+        return cover;
+    }
+
+private:
+    // A taken vertex v, or the fold of v, u, w into the vertex folded
+    struct UndoStep {
+        int v;
+        int u = -1;
+        int w = -1;
+        int folded = -1;
+    };
+
+    int CountAlive() const {
+        return std::count(Alive_.begin(), Alive_.end(), true);
+    }
+
+    // Alive neighbors of v, removed vertices are dropped from the list on the way
+    const std::vector<int>& Neighbors(int v) {
+        auto& neighbors = Adjacency_[v];
+        neighbors.erase(std::remove_if(neighbors.begin(), neighbors.end(), [&](int u) {
+            return !Alive_[u];
+        }), neighbors.end());
+        return neighbors;
+    }
+
+    void RemoveVertex(int v) {
+        Alive_[v] = false;
+        for (int u : Adjacency_[v]) {
+            if (Alive_[u]) {
+                Degree_[u]--;
+                Queue_.push_back(u);
+            }
+        }
+    }
+
+    void Take(int v) {
+        Undo_.push_back({v});
+        TakenCount_++;
+        RemoveVertex(v);
+    }
+
+    bool AreAdjacent(int u, int w) {
+        if (Degree_[u] > Degree_[w]) {
+            std::swap(u, w);
+        }
+        const auto& neighbors = Neighbors(u);
+        return std::find(neighbors.begin(), neighbors.end(), w) != neighbors.end();
+    }
+
+    void Fold(int v, int u, int w) {
+        int folded = Adjacency_.size();
+        Adjacency_.emplace_back();
+        Alive_.push_back(true);
+        Degree_.push_back(0);
+        Mark_.resize(Adjacency_.size(), -1);
+
+        std::vector<int> merged;
+        for (int end : {u, w}) {
+            for (int y : Neighbors(end)) {
+                if (y != v && Mark_[y] != folded) {
+                    Mark_[y] = folded;
+                    merged.push_back(y);
+                }
+            }
+        }
+
+        Alive_[v] = Alive_[u] = Alive_[w] = false;
+        for (int end : {u, w}) {
+            for (int y : Adjacency_[end]) {
+                if (Alive_[y]) {
+                    Degree_[y]--;
+                }
+            }
+        }
+
+        for (int y : merged) {
+            Adjacency_[y].push_back(folded);
+            Degree_[y]++;
+            Queue_.push_back(y);
+        }
+        Degree_[folded] = merged.size();
+        Adjacency_[folded] = std::move(merged);
+        Queue_.push_back(folded);
+
+        Undo_.push_back({v, u, w, folded});
+        TakenCount_++;
+    }
+
+    void ReduceLowDegrees() {
+        while (!Queue_.empty()) {
+            int v = Queue_.back();
+            Queue_.pop_back();
+            if (!Alive_[v] || Degree_[v] > 2) {
+                continue;
+            }
+
+            if (Degree_[v] == 0) {
+                RemoveVertex(v);
                 continue;
             }
 
-            vertexCoverMask[v] = false;
-            if (!IsVertexCover(vertexCoverMask, edges)) {
-                // Can't remove v, restore it
-                vertexCoverMask[v] = true;
+            std::vector<int> neighbors = Neighbors(v);
+            if (neighbors.size() == 1) {
+                Take(neighbors[0]);
+                RemoveVertex(v);
+            } else if (AreAdjacent(neighbors[0], neighbors[1])) {
+                Take(neighbors[0]);
+                Take(neighbors[1]);
+                RemoveVertex(v);
             } else {
-                // Still a vertex cover
-                improved = true;
+                Fold(v, neighbors[0], neighbors[1]);
             }
         }
+    }
 
-        std::cout << "Optimize iteration " << iteration << ": vertex cover size = " << GetCoverSize(vertexCoverMask) << '\n';
+    void ReduceDominated() {
+        Mark_.resize(Adjacency_.size(), -1);
+        for (int v = 0; v < (int)Adjacency_.size(); v++) {
+            if (!Alive_[v]) {
+                continue;
+            }
+
+            Mark_[v] = v;
+            for (int u : Neighbors(v)) {
+                Mark_[u] = v;
+            }
+
+            for (int u : Neighbors(v)) {
+                if (Degree_[u] > Degree_[v]) {
+                    continue;
+                }
+
+                const auto& closed = Neighbors(u);
+                bool dominated = std::all_of(closed.begin(), closed.end(), [&](int y) {
+                    return Mark_[y] == v;
+                });
+                if (dominated) {
+                    Take(v);
+                    break;
+                }
+            }
+        }
+    }
+
+    void ReduceByLinearProgram() {
+        std::vector<int> index(Adjacency_.size(), -1);
+        std::vector<int> vertices;
+        for (int v = 0; v < (int)Adjacency_.size(); v++) {
+            if (Alive_[v]) {
+                index[v] = vertices.size();
+                vertices.push_back(v);
+            }
+        }
+
+        std::vector<std::pair<int, int>> edges;
+        for (int v : vertices) {
+            for (int u : Neighbors(v)) {
+                edges.push_back({index[v], index[u]});
+            }
+        }
+
+        // Both directions of every edge are listed, so the lists of the double cover are the ones of the graph
+        int n = vertices.size();
+        CsrGraph graph;
+        graph.Offset.assign(n + 1, 0);
+        for (auto [v, u] : edges) {
+            graph.Offset[v + 1]++;
+        }
+        std::partial_sum(graph.Offset.begin(), graph.Offset.end(), graph.Offset.begin());
+        graph.Neighbors.resize(edges.size());
+        std::vector<int> filled(graph.Offset.begin(), graph.Offset.end() - 1);
+        for (auto [v, u] : edges) {
+            graph.Neighbors[filled[v]++] = u;
+        }
+
+        std::vector<int> matchLeft, matchRight;
+        HopcroftKarp(graph, matchLeft, matchRight);
+
+        // Konig: Z is reachable from the free left vertices by alternating paths, the cover is (L - Z) + (R & Z)
+        std::vector<bool> reachedLeft(n, false), reachedRight(n, false);
+        std::vector<int> queue;
+        for (int v = 0; v < n; v++) {
+            if (matchLeft[v] == -1) {
+                reachedLeft[v] = true;
+                queue.push_back(v);
+            }
+        }
+        for (int head = 0; head < (int)queue.size(); head++) {
+            int v = queue[head];
+            for (int e = graph.Offset[v]; e < graph.Offset[v + 1]; e++) {
+                int u = graph.Neighbors[e];
+                if (!reachedRight[u]) {
+                    reachedRight[u] = true;
+                    if (matchRight[u] != -1 && !reachedLeft[matchRight[u]]) {
+                        reachedLeft[matchRight[u]] = true;
+                        queue.push_back(matchRight[u]);
+                    }
+                }
+            }
+        }
+
+        // x(v) is half the number of copies of v in the cover
+        for (int i = 0; i < n; i++) {
+            if (!reachedLeft[i] && reachedRight[i]) {
+                Take(vertices[i]);
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            if (reachedLeft[i] && !reachedRight[i] && Alive_[vertices[i]]) {
+                RemoveVertex(vertices[i]);
+            }
+        }
     }
+
+    // Maximum matching of the bipartite graph with the lists of graph from the left side: BFS layers from the free
+    // left vertices, then vertex-disjoint shortest augmenting paths by an iterative DFS along the layers
+    static void HopcroftKarp(const CsrGraph& graph, std::vector<int>& matchLeft, std::vector<int>& matchRight) {
+        int n = graph.GetVertexCount();
+        const int INF = std::numeric_limits<int>::max();
+        matchLeft.assign(n, -1);
+        matchRight.assign(n, -1);
+        std::vector<int> layer(n), cursor(n), queue, stack;
+
+        while (true) {
+            queue.clear();
+            for (int v = 0; v < n; v++) {
+                layer[v] = matchLeft[v] == -1 ? 0 : INF;
+                if (matchLeft[v] == -1) {
+                    queue.push_back(v);
+                }
+            }
+
+            bool found = false;
+            for (int head = 0; head < (int)queue.size(); head++) {
+                int v = queue[head];
+                for (int e = graph.Offset[v]; e < graph.Offset[v + 1]; e++) {
+                    int next = matchRight[graph.Neighbors[e]];
+                    if (next == -1) {
+                        found = true;
+                    } else if (layer[next] == INF) {
+                        layer[next] = layer[v] + 1;
+                        queue.push_back(next);
+                    }
+                }
+            }
+            if (!found) {
+                break;
+            }
+
+            std::copy(graph.Offset.begin(), graph.Offset.end() - 1, cursor.begin());
+            for (int source = 0; source < n; source++) {
+                if (matchLeft[source] != -1) {
+                    continue;
+                }
+
+                stack = {source};
+                while (!stack.empty()) {
+                    int v = stack.back();
+                    if (cursor[v] == graph.Offset[v + 1]) {
+                        layer[v] = INF;
+                        stack.pop_back();
+                        if (!stack.empty()) {
+                            cursor[stack.back()]++;
+                        }
+                        continue;
+                    }
+
+                    int u = graph.Neighbors[cursor[v]];
+                    int next = matchRight[u];
+                    if (next == -1) {
+                        // Augment along the stack, cursors point to the edges of the path
+                        for (int w : stack) {
+                            int right = graph.Neighbors[cursor[w]];
+                            matchLeft[w] = right;
+                            matchRight[right] = w;
+                        }
+                        for (int w : stack) {
+                            layer[w] = INF;
+                        }
+                        break;
+                    }
+
+                    if (layer[next] == layer[v] + 1) {
+                        stack.push_back(next);
+                    } else {
+                        cursor[v]++;
+                    }
+                }
+            }
+        }
+    }
+
+    int OriginalCount_;
+    std::vector<std::vector<int>> Adjacency_;
+    std::vector<bool> Alive_;
+    std::vector<int> Degree_;
+    std::vector<int> Queue_;
+    std::vector<int> Mark_;
+    std::vector<UndoStep> Undo_;
+    int TakenCount_ = 0;
+
+    std::vector<int> KernelIndex_;
+    std::vector<int> KernelVertices_;
+    std::vector<std::pair<int, int>> KernelEdges_;
+};
+
+// Vertex lists of the connected components of the graph, largest first
+std::vector<std::vector<int>> FindComponents(const CsrGraph& graph) {
+    int n = graph.GetVertexCount();
+    std::vector<bool> visited(n, false);
+    std::vector<std::vector<int>> components;
+    for (int start = 0; start < n; start++) {
+        if (visited[start]) {
+            continue;
+        }
+
+        visited[start] = true;
+        std::vector<int> component = {start};
+        for (int head = 0; head < (int)component.size(); head++) {
+            int v = component[head];
+            for (int e = graph.Offset[v]; e < graph.Offset[v + 1]; e++) {
+                int u = graph.Neighbors[e];
+                if (!visited[u]) {
+                    visited[u] = true;
+                    component.push_back(u);
+                }
+            }
+        }
+        components.push_back(std::move(component));
+    }
+
+    std::stable_sort(components.begin(), components.end(), [](const auto& a, const auto& b) {
+        return a.size() > b.size();
+    });
+    return components;
 }
 
-int main() {
+// Minimum cover of one small component by branch and reduce over bit masks. Degree 0 vertices are dropped and
+// neighbors of degree 1 vertices taken, then the search branches on a vertex of maximum degree: either it or all of
+// its neighbors are in the cover. A branch is cut when the cover so far plus a lower bound for the rest (a greedy
+// maximal matching, edges over the maximum degree and, when these are not enough, the LP relaxation) is no better
+// than the best cover. Gives up after EXACT_NODE_LIMIT branches, keeping the best cover found
+class ExactCoverSolver {
+public:
+    // initialCover lists the vertices of a known cover of the component. local is scratch space of -1 for every
+    // vertex of the graph, it is used for the positions in the component and left as it was, so the cost does not
+    // depend on the size of the graph
+    ExactCoverSolver(const CsrGraph& graph, const std::vector<int>& component, const std::vector<int>& initialCover,
+                     std::vector<int>& local)
+        : N_(component.size())
+        , Words_((N_ + 63) / 64)
+        , Adjacency_((size_t)N_ * Words_, 0)
+        , Best_(initialCover)
+    {
+        for (int i = 0; i < N_; i++) {
+            local[component[i]] = i;
+        }
+
+        for (int i = 0; i < N_; i++) {
+            int v = component[i];
+            for (int e = graph.Offset[v]; e < graph.Offset[v + 1]; e++) {
+                int j = local[graph.Neighbors[e]];
+                Adjacency_[(size_t)i * Words_ + j / 64] |= uint64_t(1) << (j % 64);
+            }
+        }
+
+        for (int& v : Best_) {
+            v = local[v];
+        }
+        for (int v : component) {
+            local[v] = -1;
+        }
+    }
+
+    // True if the search finished, i.e. the cover is optimal
+    bool Solve() {
+        std::vector<uint64_t> alive(Words_, 0);
+        for (int i = 0; i < N_; i++) {
+            alive[i / 64] |= uint64_t(1) << (i % 64);
+        }
+
+        Nodes_ = 0;
+        std::vector<int> chosen;
+        Branch(alive, chosen);
+        return Nodes_ <= EXACT_NODE_LIMIT;
+    }
+
+    // Cover in local indices, the positions of the vertices in the component
+    const std::vector<int>& GetCover() const {
+        return Best_;
+    }
+
+private:
+    const uint64_t* Row(int v) const {
+        return Adjacency_.data() + (size_t)v * Words_;
+    }
+
+    int Degree(int v, const std::vector<uint64_t>& alive) const {
+        int degree = 0;
+        for (int w = 0; w < Words_; w++) {
+            degree += __builtin_popcountll(Row(v)[w] & alive[w]);
+        }
+        return degree;
+    }
+
+    void Take(int v, std::vector<uint64_t>& alive, std::vector<int>& chosen) const {
+        alive[v / 64] &= ~(uint64_t(1) << (v % 64));
+        chosen.push_back(v);
+    }
+
+    template <typename Callback>
+    void ForEachAlive(const std::vector<uint64_t>& alive, const uint64_t* mask, Callback callback) const {
+        for (int w = 0; w < Words_; w++) {
+            uint64_t bits = alive[w] & (mask == nullptr ? ~uint64_t(0) : mask[w]);
+            while (bits != 0) {
+                callback(w * 64 + __builtin_ctzll(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    // Augmenting path search of Kuhn's algorithm from left vertex v, visited marks right vertices
+    bool Augment(int v, const std::vector<uint64_t>& alive, std::vector<uint64_t>& visited, std::vector<int>& matchRight) const {
+        for (int w = 0; w < Words_; w++) {
+            uint64_t bits = Row(v)[w] & alive[w] & ~visited[w];
+            while (bits != 0) {
+                int u = w * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                visited[w] |= uint64_t(1) << (u % 64);
+                if (matchRight[u] == -1 || Augment(matchRight[u], alive, visited, matchRight)) {
+                    matchRight[u] = v;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Optimum of the LP relaxation rounded up: half of a maximum matching in the bipartite double cover, like in
+    // the Nemhauser-Trotter reduction of the kernel
+    int LpBound(const std::vector<uint64_t>& alive) const {
+        std::vector<int> matchRight(N_, -1);
+        std::vector<uint64_t> visited(Words_);
+        int matching = 0;
+        ForEachAlive(alive, nullptr, [&](int v) {
+            std::fill(visited.begin(), visited.end(), 0);
+            matching += Augment(v, alive, visited, matchRight);
+        });
+        return (matching + 1) / 2;
+    }
+
+    void Branch(std::vector<uint64_t> alive, std::vector<int>& chosen) {
+        if (++Nodes_ > EXACT_NODE_LIMIT) {
+            return;
+        }
+        size_t chosenBefore = chosen.size();
+
+        // Low degree rules until nothing changes
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            ForEachAlive(alive, nullptr, [&](int v) {
+                if (!(alive[v / 64] >> (v % 64) & 1)) {
+                    return;
+                }
+
+                int degree = Degree(v, alive);
+                if (degree == 0) {
+                    alive[v / 64] &= ~(uint64_t(1) << (v % 64));
+                    changed = true;
+                } else if (degree == 1) {
+                    ForEachAlive(alive, Row(v), [&](int u) {
+                        Take(u, alive, chosen);
+                    });
+                    changed = true;
+                }
+            });
+        }
+
+        // Greedy maximal matching: every matched edge needs its own cover vertex. Also no cover vertex
+        // covers more than the maximum degree edges
+        std::vector<uint64_t> unmatched = alive;
+        int matching = 0;
+        int branchVertex = -1;
+        int maxDegree = 0;
+        int degreeSum = 0;
+        ForEachAlive(alive, nullptr, [&](int v) {
+            int degree = Degree(v, alive);
+            degreeSum += degree;
+            if (degree > maxDegree) {
+                maxDegree = degree;
+                branchVertex = v;
+            }
+
+            if (!(unmatched[v / 64] >> (v % 64) & 1)) {
+                return;
+            }
+            for (int w = 0; w < Words_; w++) {
+                uint64_t bits = Row(v)[w] & unmatched[w];
+                if (bits != 0) {
+                    int u = w * 64 + __builtin_ctzll(bits);
+                    unmatched[v / 64] &= ~(uint64_t(1) << (v % 64));
+                    unmatched[u / 64] &= ~(uint64_t(1) << (u % 64));
+                    matching++;
+                    break;
+                }
+            }
+        });
+
+        int lowerBound = branchVertex == -1 ? 0 : std::max(matching, (degreeSum / 2 + maxDegree - 1) / maxDegree);
+        if (branchVertex != -1 && chosen.size() + lowerBound < Best_.size()) {
+            lowerBound = std::max(lowerBound, LpBound(alive));
+        }
+
+        if (branchVertex == -1) {
+            if (chosen.size() < Best_.size()) {
+                Best_ = chosen;
+            }
+        } else if (chosen.size() + lowerBound < Best_.size()) {
+            // The vertex itself
+            std::vector<uint64_t> withVertex = alive;
+            Take(branchVertex, withVertex, chosen);
+            Branch(withVertex, chosen);
+            chosen.pop_back();
+
+            // All of its neighbors
+            std::vector<uint64_t> withNeighbors = alive;
+            size_t before = chosen.size();
+            ForEachAlive(alive, Row(branchVertex), [&](int u) {
+                Take(u, withNeighbors, chosen);
+            });
+            withNeighbors[branchVertex / 64] &= ~(uint64_t(1) << (branchVertex % 64));
+            Branch(withNeighbors, chosen);
+            chosen.resize(before);
+        }
+
+        chosen.resize(chosenBefore);
+    }
+
+    int N_;
+    int Words_;
+    std::vector<uint64_t> Adjacency_;
+    std::vector<int> Best_;
+    long long Nodes_ = 0;
+};
+
+// Runs job(thread, task) for tasks [0, taskCount) on threadCount threads numbered from 0. Tasks are dealt round-robin
+// to per-thread deques in order; a thread takes from the front of its own deque and, once it is empty, steals from
+// the back of the others
+template <typename Job>
+void RunWorkStealing(int taskCount, int threadCount, Job job) {
+    threadCount = std::max(1, std::min(threadCount, taskCount));
+    std::vector<std::deque<int>> queues(threadCount);
+    std::vector<std::mutex> locks(threadCount);
+    for (int task = 0; task < taskCount; task++) {
+        queues[task % threadCount].push_back(task);
+    }
+
+    auto worker = [&](int self) {
+        while (true) {
+            int task = -1;
+            {
+                std::lock_guard<std::mutex> guard(locks[self]);
+                if (!queues[self].empty()) {
+                    task = queues[self].front();
+                    queues[self].pop_front();
+                }
+            }
+            for (int other = 1; task == -1 && other < threadCount; other++) {
+                int victim = (self + other) % threadCount;
+                std::lock_guard<std::mutex> guard(locks[victim]);
+                if (!queues[victim].empty()) {
+                    task = queues[victim].back();
+                    queues[victim].pop_back();
+                }
+            }
+
+            if (task == -1) {
+                return;
+            }
+            job(self, task);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threadCount; t++) {
+        workers.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto& thread : workers) {
+        thread.join();
+    }
+}
+
+// Replaces the cover of every component with at most EXACT_MAX_VERTICES vertices by an exact one, largest components
+// first on a work-stealing pool; larger components keep the heuristic cover. Returns the number of components proved
+// optimal
+int SolveComponentsExactly(const CsrGraph& graph, Bitset& vertexCoverMask, int threadCount) {
+    auto components = FindComponents(graph);
+    std::vector<int> small;
+    for (int c = 0; c < (int)components.size(); c++) {
+        if (components[c].size() <= EXACT_MAX_VERTICES) {
+            small.push_back(c);
+        }
+    }
+
+    // Positions in the current component for every thread, allocated on the first use
+    std::vector<std::vector<int>> local(threadCount);
+    std::vector<std::vector<int>> covers(small.size());
+    std::vector<char> optimal(small.size(), false);
+    RunWorkStealing(small.size(), threadCount, [&](int thread, int task) {
+        if (local[thread].empty()) {
+            local[thread].assign(graph.GetVertexCount(), -1);
+        }
+
+        const auto& component = components[small[task]];
+        std::vector<int> initialCover;
+        for (int v : component) {
+            if (vertexCoverMask[v]) {
+                initialCover.push_back(v);
+            }
+        }
+
+        ExactCoverSolver solver(graph, component, initialCover, local[thread]);
+        optimal[task] = solver.Solve();
+        for (int i : solver.GetCover()) {
+            covers[task].push_back(component[i]);
+        }
+    });
+
+    for (int task = 0; task < (int)small.size(); task++) {
+        for (int v : components[small[task]]) {
+            vertexCoverMask.Reset(v);
+        }
+        for (int v : covers[task]) {
+            vertexCoverMask.Set(v);
+        }
+    }
+
+    return std::count(optimal.begin(), optimal.end(), true);
+}
+
+void WriteCover(const Bitset& vertexCoverMask, const std::string& path) {
+    std::ofstream fout(path);
+    for (int i = 0; i < vertexCoverMask.GetSize(); i++) {
+        if (vertexCoverMask[i]) {
+            fout << i + 1 << ' ';
+        }
+    }
+    fout << '\n';
+    fout.close();
+}
+
+// NuMVC/FastVC-style local search for a smaller cover. The score of a vertex is the weight of the edges it would
+// cover when added or uncover when removed, read off CoverCounters. Whenever the current set is a cover, it is
+// recorded and its worst vertex is dropped; otherwise a step swaps a cover vertex (best of BMS_SAMPLES random ones,
+// as in FastVC) for an endpoint of a random uncovered edge, where only vertices whose neighborhood changed since they
+// left the cover may enter (configuration checking). All edges weigh 1 unless weighted: then, as in NuMVC, weights
+// of uncovered edges grow every step and are scaled down once their average exceeds the threshold. On random sparse
+// graphs weighted scores lose to the plain ones, and the more weight is kept the worse: with an average of 50 the
+// uncovered set grows to thousands of edges and the search stalls, so weights are off by default.
+// Cover vertices and uncovered edges live in arrays with index maps for O(1) updates. Vertices with loops never
+// leave the cover
+class CoverLocalSearch {
+public:
+    CoverLocalSearch(const CsrGraph& graph, const std::vector<std::pair<int, int>>& edges,
+                     Bitset cover, unsigned seed, bool weighted)
+        : Graph_(graph)
+        , Edges_(edges)
+        , Random_(seed)
+        , Counters_(graph, ForceLoops(cover, edges))
+        , Best_(cover)
+        , Weighted_(weighted)
+        , CoverIndex_(graph.GetVertexCount(), -1)
+        , ConfigurationChanged_(graph.GetVertexCount(), true)
+        , LastMoved_(graph.GetVertexCount(), 0)
+        , UncoveredIndex_(edges.size(), -1)
+    {
+        Bitset forced(graph.GetVertexCount());
+        for (auto [v, u] : edges) {
+            if (v == u) {
+                forced.Set(v);
+            }
+        }
+
+        for (int v = 0; v < Graph_.GetVertexCount(); v++) {
+            if (cover[v] && !forced[v]) {
+                CoverIndex_[v] = CoverList_.size();
+                CoverList_.push_back(v);
+            }
+        }
+        for (int e = 0; e < (int)edges.size(); e++) {
+            if (!cover[edges[e].first] && !cover[edges[e].second]) {
+                AddUncovered(e);
+            }
+        }
+        if (Weighted_) {
+            Counters_.SetWeights(std::vector<int>(edges.size(), 1));
+        }
+        TotalWeight_ = edges.size();
+
+        BestSize_ = Uncovered_.empty() ? cover.Count() : Graph_.GetVertexCount() + 1;
+    }
+
+    // Runs until the time limit. onProgress(best, improved) is called with improved = true for every new best cover
+    // and with false every PROGRESS_INTERVAL steps, so the caller can save the best cover at its own pace
+    template <typename Callback>
+    void Run(double timeLimit, Callback onProgress) {
+        auto start = std::chrono::steady_clock::now();
+        auto elapsed = [&]() {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        };
+
+        int lastAdded = -1;
+        for (long long step = 1;; step++) {
+            if (step % PROGRESS_INTERVAL == 0) {
+                if (elapsed() >= timeLimit) {
+                    break;
+                }
+                onProgress(Best_, false);
+            }
+
+            if (Uncovered_.empty()) {
+                int size = Counters_.GetCover().Count();
+                if (size < BestSize_) {
+                    BestSize_ = size;
+                    Best_ = Counters_.GetCover();
+                    onProgress(Best_, true);
+                }
+                if (CoverList_.empty()) {
+                    break;
+                }
+
+                Remove(PickToRemove(-1), step);
+                continue;
+            }
+
+            int removed = PickToRemove(lastAdded);
+            if (removed == -1) {
+                break;
+            }
+            Remove(removed, step);
+
+            auto [a, b] = Edges_[Uncovered_[Random_() % Uncovered_.size()]];
+            int added = a;
+            if (!ConfigurationChanged_[a]
+                || (ConfigurationChanged_[b] && std::make_pair(Score(b), -LastMoved_[b])
+                                                > std::make_pair(Score(a), -LastMoved_[a]))) {
+                added = b;
+            }
+            Add(added, step);
+            lastAdded = added;
+
+            if (Weighted_) {
+                for (int e : Uncovered_) {
+                    Counters_.AddWeight(e, Edges_[e].first, Edges_[e].second, 1);
+                }
+                TotalWeight_ += Uncovered_.size();
+                if (TotalWeight_ > WEIGHT_AVERAGE_LIMIT * (long long)Edges_.size()) {
+                    ForgetWeights();
+                }
+            }
+        }
+    }
+
+    const Bitset& GetBest() const {
+        return Best_;
+    }
+
+private:
+    static constexpr int BMS_SAMPLES = 50;
+    static constexpr long long PROGRESS_INTERVAL = 1024;
+    static constexpr double WEIGHT_AVERAGE_LIMIT = 1.1;
+    static constexpr double WEIGHT_FORGET_FACTOR = 0.3;
+
+    // The cover with the vertices of all loops added
+    static const Bitset& ForceLoops(Bitset& cover, const std::vector<std::pair<int, int>>& edges) {
+        for (auto [v, u] : edges) {
+            if (v == u) {
+                cover.Set(v);
+            }
+        }
+        return cover;
+    }
+
+    // Gain of an outside vertex, minus the loss of a cover vertex
+    long long Score(int v) const {
+        return Counters_.GetCover()[v] ? -Counters_.GetOutside(v) : Counters_.GetOutside(v);
+    }
+
+    void AddUncovered(int e) {
+        UncoveredIndex_[e] = Uncovered_.size();
+        Uncovered_.push_back(e);
+    }
+
+    void RemoveUncovered(int e) {
+        int last = Uncovered_.back();
+        Uncovered_[UncoveredIndex_[e]] = last;
+        UncoveredIndex_[last] = UncoveredIndex_[e];
+        Uncovered_.pop_back();
+        UncoveredIndex_[e] = -1;
+    }
+
+    void ForgetWeights() {
+        std::vector<int> weights(Edges_.size());
+        TotalWeight_ = 0;
+        for (int e = 0; e < (int)Edges_.size(); e++) {
+            weights[e] = std::max(1, (int)(Counters_.GetWeight(e) * WEIGHT_FORGET_FACTOR));
+            TotalWeight_ += weights[e];
+        }
+        Counters_.SetWeights(std::move(weights));
+    }
+
+    // Best of BMS_SAMPLES random cover vertices by score, the least recently moved on ties
+    int PickToRemove(int tabu) {
+        int best = -1;
+        for (int sample = 0; sample < BMS_SAMPLES; sample++) {
+            int v = CoverList_[Random_() % CoverList_.size()];
+            if (v == tabu) {
+                continue;
+            }
+            if (best == -1 || std::make_pair(Score(v), -LastMoved_[v]) > std::make_pair(Score(best), -LastMoved_[best])) {
+                best = v;
+            }
+        }
+
+        return best;
+    }
+
+    void Add(int v, long long step) {
+        Counters_.Add(v);
+        CoverIndex_[v] = CoverList_.size();
+        CoverList_.push_back(v);
+        LastMoved_[v] = step;
+
+        for (int i = Graph_.Offset[v]; i < Graph_.Offset[v + 1]; i++) {
+            int u = Graph_.Neighbors[i];
+            if (u == v) {
+                continue;
+            }
+
+            ConfigurationChanged_[u] = true;
+            if (!Counters_.GetCover()[u]) {
+                RemoveUncovered(Graph_.EdgeIds[i]);
+            }
+        }
+    }
+
+    void Remove(int v, long long step) {
+        Counters_.Remove(v);
+        int last = CoverList_.back();
+        CoverList_[CoverIndex_[v]] = last;
+        CoverIndex_[last] = CoverIndex_[v];
+        CoverList_.pop_back();
+        CoverIndex_[v] = -1;
+        LastMoved_[v] = step;
+        ConfigurationChanged_[v] = false;
+
+        for (int i = Graph_.Offset[v]; i < Graph_.Offset[v + 1]; i++) {
+            int u = Graph_.Neighbors[i];
+            if (u == v) {
+                continue;
+            }
+
+            ConfigurationChanged_[u] = true;
+            if (!Counters_.GetCover()[u]) {
+                AddUncovered(Graph_.EdgeIds[i]);
+            }
+        }
+    }
+
+    const CsrGraph& Graph_;
+    const std::vector<std::pair<int, int>>& Edges_;
+    std::mt19937 Random_;
+
+    CoverCounters Counters_;
+    Bitset Best_;
+    int BestSize_;
+    bool Weighted_;
+
+    std::vector<int> CoverList_;
+    std::vector<int> CoverIndex_;
+    std::vector<bool> ConfigurationChanged_;
+    std::vector<long long> LastMoved_;
+
+    long long TotalWeight_ = 0;
+    std::vector<int> Uncovered_;
+    std::vector<int> UncoveredIndex_;
+};
+
+int main(int argc, char** argv) {
+    double timeLimit = 0.0;
+    unsigned seed = 0;
+    bool edgeWeights = false;
+    int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--time-limit=", 0) == 0) {
+            timeLimit = std::atof(arg.c_str() + std::string("--time-limit=").size());
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            seed = std::strtoul(arg.c_str() + std::string("--seed=").size(), nullptr, 10);
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            threadCount = std::max(1, std::atoi(arg.c_str() + std::string("--threads=").size()));
+        } else if (arg == "--edge-weights") {
+            edgeWeights = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << '\n'
+                      << "Usage: vertex-cover [--time-limit=SECONDS] [--seed=N] [--edge-weights] [--threads=N]\n";
+            return 1;
+        }
+    }
+
     std::ifstream fin("input.txt");
     std::vector<std::pair<int, int>> edges;
 
@@ -92,21 +1297,66 @@ int main() {
 
     std::cout << "Graph: " << verticesCount << " vertices, " << edges.size() << " edges" << '\n';
 
-    std::cout << "Running base algorithm...\n";
-    auto vertexCoverMask = EdgeBasedApproximation(edges, verticesCount);
-    std::cout << "Cover size found by base algorithm: " << GetCoverSize(vertexCoverMask) << '\n';
+    std::cout << "Reducing the graph...\n";
+    Kernel kernel(edges, verticesCount);
+    kernel.Reduce();
+    int taken = kernel.GetTakenCount();
+    std::cout << "Kernel: " << kernel.GetVertexCount() << " vertices, " << kernel.GetEdges().size() << " edges, "
+              << taken << " cover vertices decided by reductions\n";
+
+    auto graph = BuildCsrGraph(kernel.GetEdges(), kernel.GetVertexCount());
+
+    std::cout << "\nRunning base algorithm...\n";
+    auto vertexCoverMask = EdgeBasedApproximation(graph);
+    std::cout << "Cover size found by base algorithm: " << taken + GetCoverSize(vertexCoverMask) << '\n';
     
     std::cout << "\nOptimizing by removing redundant vertices..." << '\n';
-    RemoveRedundantVertices(vertexCoverMask, edges);
+    RemoveRedundantVertices(vertexCoverMask, graph);
+    std::cout << "Cover size after removing redundant vertices: " << taken + GetCoverSize(vertexCoverMask) << '\n';
 
-    std::ofstream fout("output.txt");
-    for (int i = 0; i < verticesCount; i++) {
-        if (vertexCoverMask[i]) {
-            fout << i + 1 << ' ';
+    std::cout << "\nSolving small components exactly...\n";
+    int optimalComponents = SolveComponentsExactly(graph, vertexCoverMask, threadCount);
+    std::cout << optimalComponents << " components proved optimal, cover size: "
+              << taken + GetCoverSize(vertexCoverMask) << '\n';
+
+    // Every cover is checked against the input edges before it replaces output.txt
+    auto writeOutput = [&](const Bitset& kernelCover) {
+        auto cover = kernel.Lift(kernelCover);
+        if (!IsVertexCover(cover, edges)) {
+            std::cerr << "Lifted set of " << GetCoverSize(cover) << " vertices is not a vertex cover, not written\n";
+            return;
         }
+        WriteCover(cover, "output.txt");
+    };
+
+    writeOutput(vertexCoverMask);
+
+    if (timeLimit > 0) {
+        std::cout << "\nRunning local search for " << timeLimit << " seconds...\n";
+        auto start = std::chrono::steady_clock::now();
+        auto lastWrite = start - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                     std::chrono::duration<double>(COVER_WRITE_INTERVAL));
+        bool pending = false;
+        CoverLocalSearch search(graph, kernel.GetEdges(), vertexCoverMask, seed, edgeWeights);
+
+        // Every improvement is kept on disk: the first one at once, later ones as soon as the interval since the
+        // previous write has passed, so a large cover is not rewritten more than once per interval
+        search.Run(timeLimit, [&](const Bitset& cover, bool improved) {
+            pending = pending || improved;
+            auto now = std::chrono::steady_clock::now();
+            if (pending && std::chrono::duration<double>(now - lastWrite).count() >= COVER_WRITE_INTERVAL) {
+                writeOutput(cover);
+                lastWrite = now;
+                pending = false;
+                std::cout << "Cover size " << taken + GetCoverSize(cover) << " after "
+                          << std::chrono::duration<double>(now - start).count() << " s\n";
+            }
+        });
+
+        vertexCoverMask = search.GetBest();
+        writeOutput(vertexCoverMask);
+        std::cout << "Cover size after local search: " << taken + GetCoverSize(vertexCoverMask) << '\n';
     }
-    fout << '\n';
-    fout.close();
 
     return 0;
 }